@@ -27,6 +27,10 @@
 #include <assert.h>
 #include <bit>
 #include <array>
+#include <span>
+#include <cstddef>
+
+#include "thread_pool.h"
 
 // check endiannes before assigning n_V to big/little endian version
 static consteval bool is_big_endian() {
@@ -78,6 +82,17 @@ class FullTimePad
 					{1, 24, 16, 9, 0, 25, 17, 8, 15, 22, 30, 7, 14, 23, 31, 6, 13, 20, 28, 5, 12, 21, 29, 4, 3, 26, 18, 11, 2, 27, 19, 10},
 			}};
 
+	public:
+			// permutation schedule: a type with a constexpr 16x32 table n_V_big_endian. The kernels are compiled for the
+			// schedule they are given, so a candidate schedule runs at the speed of the shipped one. Changing it changes the cipher.
+			// The library is built for this one, other schedules are compiled by including fulltimepad_kernels.h
+			struct DefaultSchedule {
+				static constexpr const std::array<std::array<uint8_t, 32>, 16> &n_V_big_endian = FullTimePad::n_V_big_endian;
+			};
+
+	private:
+			// n_V of Schedule for the native byte order of the 32-bit key words, generated from its n_V_big_endian
+			template<typename Schedule>
 			static consteval std::array<std::array<uint8_t, 32>, 16> get_n_V();
 
 	public:
@@ -88,10 +103,26 @@ class FullTimePad
 				Version20 = 20 // Version 2.0 - less complexity, most speed
 			};
 
+			// byte range [offset, offset+length) of a message for transform_ranges
+			struct Range {
+				const uint8_t *in; // message bytes from offset on
+				uint8_t *out; // output, either in itself (in-place) or a buffer that doesn't overlap in
+				uint64_t offset; // offset of in within the message
+				size_t length;
+			};
+
 	private: 
 			
 			// for modular addition in a Prime Galois Field, field size p, largest 32-bit unsigned prime number
 			static const constexpr uint32_t fp = 4294967291; // 0xfffffffb
+
+			// x % fp without a division: 2^32 = 5 (mod fp), so the high word is folded into the low word times 5 (twice for
+			// any 64-bit x) and fp is subtracted once with a mask. Same instructions for every x, no data dependent timing
+			static constexpr inline uint32_t mod_fp(uint64_t x) {
+				x = (x & 0xffffffff) + (x >> 32) * 5; // < 6*2^32
+				x = (x & 0xffffffff) + (x >> 32) * 5; // < 2^32 + 25
+				return x - (fp & -(uint64_t)(x >= fp));
+			}
 		
 			/*
 			// indexes represented as constant when rotated V right by n
@@ -150,38 +181,317 @@ class FullTimePad
 			};
 
 			// bitwise right rotation
-			static inline uint32_t rotr(uint32_t x, uint8_t shift) {
+			static constexpr inline uint32_t rotr(uint32_t x, uint8_t shift) {
 				return (x >> shift) | (x << ((sizeof(x) << 3) - shift));
 			}
 			
 			// bitwise left rotation
-			static inline uint32_t rotl(uint32_t x, uint8_t shift) {
+			static constexpr inline uint32_t rotl(uint32_t x, uint8_t shift) {
 			    return (x << shift) | (x >> ((sizeof(x) << 3) - shift));
 			}
 		
-			// initial key, before any permutation
-			uint8_t *init_key;
-
-			// placeholder transformed key
-			uint8_t *transformed_key;
-		
-			// safely delete the inital key
-			bool terminate_k = false;
+			// initial key as 32-bit big endian words, before any permutation. A copy owned by the object, zeroed on destruction
+			alignas(32) std::array<uint32_t, 8> init_k;
 			
 			// iterations for the main transformation loop
-			template<Version version=Version10>
-			void transformation(uint8_t *key, uint64_t encryption_index); // length of k is 8
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			static void transformation(uint32_t *k, uint64_t encryption_index); // length of k is 8
+
+			// the rounds of every version on the key words k[0..7]. permute(a, b, c, d, e, f, g, h, ni) applies dynamic permutation ni
+			// to the words, so the same rounds run with the SIMD shuffles (transformation) and in constant evaluation (constexpr_permute)
+			template<Version version, typename Permute>
+			static constexpr void rounds(uint32_t *k, uint64_t encryption_index, Permute permute)
+			{
+				// run the wanted version
+				if constexpr (version == FullTimePad::Version10) {
+					// constant array used in the transformation of the key
+					uint32_t A[8] = {
+						0,	// encryption index 
+						0,	// encryption index 
+						0x119f904f,
+						0x73d44db5,
+						0x3918fa83,
+						0x5546b403,
+						0x216c46df,
+						0x64997dfd,
+					};
+
+					// Incorporate the the encryption_index here
+					A[0] = encryption_index >> 32;
+					A[1] = encryption_index; // implicit & 0xffffffff
+
+					// one iteration, every index and rotation is resolved at compile time so k and A can stay in registers
+					auto single_iteration = [&]<uint8_t i>() {
+						constexpr uint8_t index = i<<2;
+						constexpr uint8_t i1mod = index % 8;
+						constexpr uint8_t i2mod = (index+1) % 8;
+						constexpr uint8_t i3mod = (index+2) % 8;
+						constexpr uint8_t i4mod = (index+3) % 8;
+						constexpr uint8_t imod8 = i % 8;
+						constexpr uint8_t imod9 = (i+1) % 8;
+
+						constexpr uint8_t rmod = i % 5; // 5 rotation values
+						k[i1mod] = mod_fp((uint64_t)k[i1mod] + A[imod8]  + rotr(k[i1mod], r[rmod]));
+
+						uint32_t sum = mod_fp((uint64_t)k[0] + k[1] + k[2] + k[3] + k[4] + k[5] + k[6] + k[7]);
+
+						A[imod9] ^= sum;
+
+						k[i2mod] = mod_fp(((uint64_t)k[i2mod] + A[imod9]) + rotl(k[i2mod], r[rmod])); // uint64_t to make sure there is no unwanted overflow
+
+						A[imod8] ^= mod_fp((uint64_t)k[i2mod] + rotr(k[i1mod], r[(i+1)%5]));
+
+						k[i3mod] = mod_fp((uint64_t)(A[imod8] ^ k[i3mod]) + (A[imod9] ^ k[i4mod]));
+						k[i4mod] = mod_fp((uint64_t)(A[imod8] ^ k[i4mod]) + (A[imod9] ^ k[i3mod]));
+
+						// permutate the key
+						permute(k[0], k[1], k[2], k[3], k[4], k[5], k[6], k[7], i);
+					};
+
+					// 16 iterations, unrolled
+					[&]<uint8_t... i>(std::integer_sequence<uint8_t, i...>) {
+						(single_iteration.template operator()<i>(), ...);
+					}(std::make_integer_sequence<uint8_t, 16>());
+				} else if constexpr(version == FullTimePad::Version11) {
+					// constant array used in the transformation of the key
+					uint32_t A[8] = {
+						0,	// encryption index 
+						0,	// encryption index 
+						0x119f904f,
+						0x73d44db5,
+						0x3918fa83,
+						0x5546b403,
+						0x216c46df,
+						0x64997dfd,
+					};
+
+					// Incorporate the the encryption_index here
+					A[0] = encryption_index >> 32;
+					A[1] = encryption_index; // implicit & 0xffffffff
+
+					// one iteration, every index and rotation is resolved at compile time so k and A can stay in registers
+					auto single_iteration = [&]<uint8_t i>() {
+						constexpr uint8_t index = i<<2;
+						constexpr uint8_t i1mod = index % 8;
+						constexpr uint8_t i2mod = (index+1) % 8;
+						constexpr uint8_t i3mod = (index+2) % 8;
+						constexpr uint8_t i4mod = (index+3) % 8;
+						constexpr uint8_t imod8 = i % 8;
+						constexpr uint8_t imod9 = (i+1) % 8;
+
+						constexpr uint8_t rmod = i % 5; // 5 rotation values
+						k[i1mod] = mod_fp((uint64_t)k[i1mod] + A[imod8]  + rotr(k[i1mod], r[rmod]));
+
+						uint32_t sum = mod_fp((uint64_t)k[0] + k[1] + k[2] + k[3] + k[4] + k[5] + k[6] + k[7]);
+
+						A[imod9] = mod_fp(A[imod9] ^ sum);
+
+						k[i2mod] = mod_fp(((uint64_t)k[i2mod] + A[imod9]) + rotl(k[i2mod], r[rmod])); // uint64_t to make sure there is no unwanted overflow
+
+						A[imod8] = mod_fp(A[imod8] ^ k[i2mod]);
+
+						k[i3mod] = mod_fp(A[imod8] ^ k[i3mod]);
+						k[i4mod] = mod_fp(A[imod8] ^ k[i4mod]);
+
+						// permutate the key
+						permute(k[0], k[1], k[2], k[3], k[4], k[5], k[6], k[7], i);
+					};
+
+					// 16 iterations, unrolled
+					[&]<uint8_t... i>(std::integer_sequence<uint8_t, i...>) {
+						(single_iteration.template operator()<i>(), ...);
+					}(std::make_integer_sequence<uint8_t, 16>());
+				} else { // Version 2.0
+					auto single_iteration = [](uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d, uint32_t &j, uint32_t &l,
+											   uint32_t e, uint32_t f, uint32_t g, uint32_t h, // e,f,g,h is for values for sum
+											   const uint8_t &&rmod) {
+			 			// k[i1mod] = k[i1mod] + rotr(k[i1mod], r[rmod]) + A[imod8];
+						a += rotr(a, r[rmod]) + j;
+						// OR - for second half, a is a,e, j is j,l,m,n,o,q,s,t
+						// e = e + rotr(e, r[rmod]) + l;
+
+			 			uint32_t sum = a + b + c + d + e + f + g + h;
+
+						// A[imod9] = l,m,n,o,q,s,t,j
+			 			// A[imod9] = A[imod9] ^ sum;
+						l ^= sum;
+						// l is the mentioned above. goes from l, to j
+
+			 			// k[i2mod] = k[i2mod] + A[imod9] + rotl(k[i2mod], r[rmod]);
+						b += l + rotl(b, r[rmod]);
+						// OR - for second half, b is b,f
+
+			 			// A[imod8] = A[imod8] ^ k[i2mod];
+						j ^= b;
+						// OR - for second half, b is b,f
+
+			 			// k[i3mod] = A[imod8] ^ k[i3mod];
+						c ^= j;
+						// OR - for second half, c is c,g
+
+			 			// k[i4mod] = A[imod8] ^ k[i4mod];
+						d ^= j;
+						// OR - for second half, d is d,h
+					};
+
+					uint32_t a = k[0];
+					uint32_t b = k[1];
+					uint32_t c = k[2];
+					uint32_t d = k[3];
+					uint32_t e = k[4];
+					uint32_t f = k[5];
+					uint32_t g = k[6];
+					uint32_t h = k[7];
+
+					// Incorporate the the encryption_index here
+					uint32_t j = encryption_index >> 32;
+					uint32_t l = encryption_index; // implicit & 0xffffffff
+
+					// reset A values
+					uint32_t m = 0x119f904f;
+					uint32_t n = 0x73d44db5;
+					uint32_t o = 0x3918fa83;
+					uint32_t q = 0x5546b403;
+					uint32_t s = 0x216c46df;
+					uint32_t t = 0x64997dfd;
+
+					// assign back to k before permutation
+					auto assign = [k](uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d, uint32_t &e, uint32_t &f, uint32_t &g, uint32_t &h) {
+						k[0] = a;
+						k[1] = b;
+						k[2] = c;
+						k[3] = d;
+						k[4] = e;
+						k[5] = f;
+						k[6] = g;
+						k[7] = h;
+					};
+
+			 		// permutate the bytearray key 4 times rather than 16 (faster, doesn't effect security too much)
+					// do permutate: 1 0 0 0 1 0 0 0 1 0 0 0 1 0 0 0
+
+					single_iteration(a,b,c,d,j,l,e,f,g,h, 0); // permutate
+					permute(a, b, c, d, e, f, g, h, 0);
+					single_iteration(e,f,g,h,l,m,a,b,c,d, 1);
+					single_iteration(a,b,c,d,m,n,e,f,g,h, 2);
+					single_iteration(e,f,g,h,n,o,a,b,c,d, 3);
+					single_iteration(a,b,c,d,o,q,e,f,g,h, 4); // permutate
+					permute(a, b, c, d, e, f, g, h, 4);
+					single_iteration(e,f,g,h,q,s,a,b,c,d, 0);
+					single_iteration(a,b,c,d,s,t,e,f,g,h, 1);
+					single_iteration(e,f,g,h,t,j,a,b,c,d, 2);
+					single_iteration(a,b,c,d,j,l,e,f,g,h, 3); // dont permutate
+					//assign(a,b,c,d,e,f,g,h); // 9 rounds
+			 		//dynamic_permutation(key, 8);
+					//assign_k();
+					single_iteration(e,f,g,h,l,m,a,b,c,d, 4); // 10 rounds
+					assign(a,b,c,d,e,f,g,h);
+					//single_iteration(a,b,c,d,m,n,e,f,g,h, 0);
+					//single_iteration(e,f,g,h,n,o,a,b,c,d, 1);
+					//single_iteration(a,b,c,d,o,q,e,f,g,h, 2); // permutate
+					//assign(a,b,c,d,e,f,g,h);
+			 		//dynamic_permutation(key, 12);
+					//assign_k();
+					//single_iteration(e,f,g,h,q,s,a,b,c,d, 3);
+					//single_iteration(a,b,c,d,s,t,e,f,g,h, 4);
+					//single_iteration(e,f,g,h,t,j,a,b,c,d, 0);
+					//assign(a,b,c,d,e,f,g,h); // 16 rounds
+
+			 		// for(uint8_t i=0;i<16;i++) {
+			 		// 	uint8_t index = i<<2;
+			 		// 	uint8_t i1mod = index % 8;
+			 		// 	uint8_t i2mod = (index+1) % 8;
+			 		// 	uint8_t i3mod = (index+2) % 8;
+			 		// 	uint8_t i4mod = (index+3) % 8;
+			 		// 	uint8_t imod8 = i % 8;
+			 		// 	uint8_t imod9 = (i+1) % 8;
+
+			 		// 	uint8_t rmod = i % 5; // 5 rotation values
+			 		// 	k[i1mod] = k[i1mod] + rotr(k[i1mod], r[rmod]) + A[imod8];
+
+			 		// 	uint32_t sum = k[0] + k[1] + k[2] + k[3] + k[4] + k[5] + k[6] + k[7];
+
+			 		// 	A[imod9] = A[imod9] ^ sum;
+
+			 		// 	k[i2mod] = k[i2mod] + A[imod9] + rotl(k[i2mod], r[rmod]);
+
+			 		// 	A[imod8] = A[imod8] ^ k[i2mod];
+
+			 		// 	k[i3mod] = A[imod8] ^ k[i3mod];
+			 		// 	k[i4mod] = A[imod8] ^ k[i4mod];
+
+			 		// 	// permutate the bytearray key 4 times rather than 16 (faster, doesn't effect security too much)
+			 		// 	if( (i & 3) == 0) {
+			 		// 		dynamic_permutation(key, i);
+			 		// 	}
+
+					// 	for(int j=0;j<8;j++) {
+					// 		std::cout << std::hex << std::setw(8) << std::setfill('0') << k[j];
+					// 	}
+					// 	std::cout << std::endl;
+			 		// }
+					// exit(0);
+				}
+			}
+
+			// dynamic permutation ni of the key words with shifts, so it can be constant evaluated and the table can be any schedule.
+			// byte n_V_big_endian[ni][i] of the big endian key becomes byte i
+			static constexpr void constexpr_permute(const std::array<std::array<uint8_t, 32>, 16> &n_V_big_endian,
+													uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d, uint32_t &e, uint32_t &f, uint32_t &g, uint32_t &h, uint8_t ni)
+			{
+				const uint32_t k[8] = {a, b, c, d, e, f, g, h};
+				uint32_t p[8] = {};
+				for(uint8_t i=0;i<keysize;i++) {
+					const uint8_t from = n_V_big_endian[ni][i];
+					const uint8_t byte = k[from >> 2] >> (24 - ((from & 3) << 3));
+					p[i >> 2] |= uint32_t(byte) << (24 - ((i & 3) << 3));
+				}
+				a = p[0];
+				b = p[1];
+				c = p[2];
+				d = p[3];
+				e = p[4];
+				f = p[5];
+				g = p[6];
+				h = p[7];
+			}
 		
 			// dynamically permutate the key during iteration
 			// key: permutated 32-byte key
-			// p: dynamically re-purmutated key
 			// ni: index of dynamic permutation number n
 			// ni: iteration index
-			static void dynamic_permutation(uint8_t *key, uint8_t *p, uint8_t ni);
+			template<typename Schedule=DefaultSchedule>
+			static void dynamic_permutation(uint8_t *key, uint8_t ni);
+
+			// in-register byte shuffles for dynamic_permutation (SSSE3 pshufb, AVX2 vpshufb or AVX-512 vpermb)
+			template<typename Schedule>
+			struct shuffle_kernel;
 			
 			// convert uint8_t *key into uint32_t *k in big endian
 			static uint32_t *endian_8_to_32_arr(uint8_t *key);
 
+			// load uint8_t *key into uint32_t *k in big endian without modifying key
+			static void load_key(uint32_t *k, const uint8_t *key);
+
+			// encrypt/decrypt one block of up to 32 bytes, the transformed key words are XORed straight into out
+			// in: plaintext data
+			// out: ciphertext data, either in itself (in-place) or a buffer that doesn't overlap in
+			// length: length of in, and out. At most keysize
+			template<Version version, typename Schedule=DefaultSchedule>
+			void transform_block(const uint8_t *in, uint8_t *out, uint8_t length, uint64_t encryption_index);
+
+			// AVX2 kernel: 8 blocks at once, one block per 32-bit lane
+			template<typename Schedule>
+			struct avx2_kernel;
+
+			// AVX-512 kernel: 16 blocks at once, needs AVX512F, AVX512BW and AVX512VBMI
+			template<typename Schedule>
+			struct avx512_kernel;
+
+			// Version 1.0/1.1 rounds on the lanes of avx2_kernel or avx512_kernel
+			template<Version version, typename Kernel, typename Vector>
+			static void lane_rounds(Vector *k, Vector *A);
+
 
 	public:
 			// for testing purposes
@@ -189,29 +499,137 @@ class FullTimePad
 			template<Version version>
 			friend void inv_transformation(uint8_t *transformed_k);
 			#endif
-
-			// if you want the destructor called to safely destroy key after use is over
-			// this is to make sure that the key is deleted safely and that the ownership of the init_key isn't managed somewhere else
-			inline void terminate() noexcept;
+			#ifdef KERNELS_CPP
+			friend bool test_mod_fp();
+			#endif
 
 			const constexpr static uint8_t keysize = 32;
 
-			FullTimePad(uint8_t *initial_key);
+			// initial_key: 32-byte key, copied so the caller's buffer can be reused or wiped right away
+			explicit FullTimePad(const uint8_t *initial_key);
+
+			// move-only, so there's a single copy of the key. The moved-from object's key is zeroed
+			FullTimePad(const FullTimePad &) = delete;
+			FullTimePad &operator=(const FullTimePad &) = delete;
+			FullTimePad(FullTimePad &&other) noexcept;
+			FullTimePad &operator=(FullTimePad &&other) noexcept;
 
 			// key: 256-bit (32-byte) key, should be allocated with length keysize
-			template<Version version=Version10>
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
 			void hash(uint8_t *key, uint64_t encryption_index_nonce);
 
+			// hash of n different keys, up to 16 keys at once in the SIMD lanes
+			// keys: n 32-byte keys, one after another
+			// encryption_indexes: n encryption indexes, one per key
+			// out: n*32 bytes, block i is the hash of key i at encryption_indexes[i]
+			// Schedule: permutation schedule. Other schedules than the default are instantiated by including fulltimepad_kernels.h
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			static void hash_many(const uint8_t *keys, const uint64_t *encryption_indexes, uint8_t *out, size_t n);
+
+			// hash of key without an object, usable in constant expressions: known answers can be static_asserted and
+			// keystream for a fixed key computed at compile time. Same bytes as hash
+			// key: 32-byte initial key
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			static constexpr std::array<uint8_t, keysize> hash(const std::array<uint8_t, keysize> &key, uint64_t encryption_index)
+			{
+				return hash<version>(key, encryption_index, Schedule::n_V_big_endian);
+			}
+
+			// hash of key with a schedule only known at run time, e.g. while searching for one. Same rounds as hash,
+			// but the permutations are done with shifts instead of the compiled shuffles
+			// n_V_big_endian: permutation schedule
+			template<Version version=Version10>
+			static constexpr std::array<uint8_t, keysize> hash(const std::array<uint8_t, keysize> &key, uint64_t encryption_index,
+															   const std::array<std::array<uint8_t, 32>, 16> &n_V_big_endian)
+			{
+				std::array<uint32_t, 8> k{};
+				for(uint8_t i=0;i<8;i++) {
+					k[i] = uint32_t(key[i<<2]) << 24 | uint32_t(key[(i<<2)+1]) << 16 | uint32_t(key[(i<<2)+2]) << 8 | key[(i<<2)+3];
+				}
+				rounds<version>(k.data(), encryption_index, [&](uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d, uint32_t &e, uint32_t &f, uint32_t &g, uint32_t &h, uint8_t ni) {
+					constexpr_permute(n_V_big_endian, a, b, c, d, e, f, g, h, ni);
+				});
+
+				// the keystream is the native representation of k
+				std::array<uint8_t, keysize> keystream{};
+				for(uint8_t i=0;i<keysize;i++) {
+					keystream[i] = k[i >> 2] >> (is_big_endian() ? 24 - ((i & 3) << 3) : (i & 3) << 3);
+				}
+				return keystream;
+			}
+
+			// transform of a fixed size message without an object, usable in constant expressions. Same bytes as transform
+			// key: 32-byte initial key
+			// pt: plaintext data
+			template<Version version=Version10, size_t length>
+			static constexpr std::array<uint8_t, length> transform(const std::array<uint8_t, keysize> &key, const std::array<uint8_t, length> &pt, uint64_t encryption_index)
+			{
+				std::array<uint8_t, length> ct{};
+				for(size_t i=0;i<length;i+=keysize) {
+					const std::array<uint8_t, keysize> keystream = hash<version>(key, encryption_index++);
+					for(size_t j=0;j<keysize && i+j<length;j++) {
+						ct[i+j] = pt[i+j] ^ keystream[j];
+					}
+				}
+				return ct;
+			}
+
 			// encrypt/decrypt
-			// key is the initial key, return heap allocated key output
 			// pt: plaintext data
-			// ct: ciphertext data
+			// ct: ciphertext data, either pt itself (in-place) or a buffer that doesn't overlap pt. Partial overlap isn't allowed
 			// length: length of pt, and ct
 			// encryption_index: each encrypted value needs it's own encryption index to keep keys unieqe and to avoid collisions
-			template<Version version=Version10>
-			void transform(uint8_t *pt, uint8_t *ct, uint32_t length, uint64_t encryption_index);
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void transform(const uint8_t *pt, uint8_t *ct, size_t length, uint64_t encryption_index);
+
+			// encrypt/decrypt
+			// pt: plaintext data
+			// ct: ciphertext data, same size as pt. Either pt itself (in-place) or a buffer that doesn't overlap pt
+			// encryption_index: each encrypted value needs it's own encryption index to keep keys unieqe and to avoid collisions
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void transform(std::span<const std::byte> pt, std::span<std::byte> ct, uint64_t encryption_index);
+
+			// encrypt/decrypt data in-place, e.g. a memory-mapped file
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void transform(std::span<std::byte> data, uint64_t encryption_index);
+
+			// bytes per parallel_transform task: 2048 segments, small enough to stay in cache and to balance the threads
+			static constexpr size_t parallel_chunk = 1 << 16;
+
+			// encrypt/decrypt on all threads of pool. Same output and aliasing rules as transform. Calls from several threads share
+			// pool by taking turns, a call from inside a task of pool runs on the calling thread only (see ThreadPool::parallel_for)
+			// pt: plaintext data
+			// ct: ciphertext data
+			// length: length of pt, and ct
+			// encryption_index: encryption index of the first 32-byte segment
+			// pool: threads to use
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void parallel_transform(const uint8_t *pt, uint8_t *ct, size_t length, uint64_t encryption_index, ThreadPool &pool = ThreadPool::global());
+
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void parallel_transform(std::span<const std::byte> pt, std::span<std::byte> ct, uint64_t encryption_index, ThreadPool &pool = ThreadPool::global());
+
+			// encrypt/decrypt data in-place on all threads of pool
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void parallel_transform(std::span<std::byte> data, uint64_t encryption_index, ThreadPool &pool = ThreadPool::global());
+
+			// encrypt/decrypt the byte range [offset, offset+length) of a message, only the blocks it touches are generated
+			// in: message bytes from offset on
+			// out: output, either in itself (in-place) or a buffer that doesn't overlap in
+			// offset: offset of in within the message, doesn't have to be a multiple of 32
+			// length: length of in, and out
+			// encryption_index: encryption index of the whole message
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void transform_range(const uint8_t *in, uint8_t *out, uint64_t offset, size_t length, uint64_t encryption_index);
+
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void transform_range(std::span<const std::byte> in, std::span<std::byte> out, uint64_t offset, uint64_t encryption_index);
+
+			// transform_range for every range of a message
+			template<Version version=Version10, typename Schedule=DefaultSchedule>
+			void transform_ranges(std::span<const Range> ranges, uint64_t encryption_index);
 
-			// Destructor
+			// Destructor, zeroes the key
 			~FullTimePad();
 };
 
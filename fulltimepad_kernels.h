@@ -0,0 +1,973 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef FULLTIMEPAD_KERNELS_H
+#define FULLTIMEPAD_KERNELS_H
+
+// definitions of the member templates of FullTimePad: the rounds, the SIMD keystream kernels and the transforms built on them.
+// fulltimepad.cpp instantiates them for the default schedule. Including this header compiles them for another schedule,
+// e.g. FullTimePad::transform<version, Schedule>, at the speed of the shipped one
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <array>
+#include <utility>
+#include <algorithm>
+
+#ifdef __SSSE3__
+// GCC 12 warns about _mm512_undefined_epi32() inside its own AVX-512 headers, maybe-uninitialized once the intrinsics are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+#include "fulltimepad.h"
+#include "instrumentation.h"
+
+// the permutations are defined on the big endian key. On little endian hosts byte i of the key words in memory is
+// byte i^3 in big endian, so the native table is generated from n_V_big_endian at compile time
+template<typename Schedule>
+consteval std::array<std::array<uint8_t, 32>, 16> FullTimePad::get_n_V() {
+	if constexpr(is_big_endian()) {
+		return Schedule::n_V_big_endian;
+	} else {
+		std::array<std::array<uint8_t, 32>, 16> n_V{};
+		for(uint8_t ni=0;ni<16;ni++) {
+			for(uint8_t i=0;i<32;i++) {
+				n_V[ni][i] = Schedule::n_V_big_endian[ni][i^3] ^ 3;
+			}
+		}
+		return n_V;
+	}
+}
+
+#ifdef __SSSE3__
+// single-block dynamic permutation in vector registers, the 256-bit key never goes through memory
+template<typename Schedule>
+struct FullTimePad::shuffle_kernel
+{
+	static constexpr std::array<std::array<uint8_t, 32>, 16> n_V = get_n_V<Schedule>();
+
+	// pshufb only moves bytes inside 128-bit lanes, so every permutation is split into the bytes that stay in their lane
+	// and the bytes that cross over from the other lane. 0x80 zeroes the byte
+	static consteval std::array<std::array<uint8_t, 32>, 16> lane_mask(bool cross) {
+		std::array<std::array<uint8_t, 32>, 16> mask{};
+		for(uint8_t ni=0;ni<16;ni++) {
+			for(uint8_t i=0;i<32;i++) {
+				const bool same_lane = (n_V[ni][i] >> 4) == (i >> 4);
+				mask[ni][i] = same_lane != cross ? n_V[ni][i] & 15 : 0x80;
+			}
+		}
+		return mask;
+	}
+
+	template<bool cross>
+	alignas(32) static constexpr std::array<std::array<uint8_t, 32>, 16> mask = lane_mask(cross);
+
+	#ifdef __AVX2__
+	static inline __m256i permute(__m256i x, uint8_t ni) {
+		#if defined(__AVX512VBMI__) && defined(__AVX512VL__)
+		// vpermb: the n_V row is the index vector
+		return _mm256_permutexvar_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(n_V[ni].data())), x);
+		#else
+		const __m256i swapped = _mm256_permute2x128_si256(x, x, 0x01); // 128-bit lanes swapped
+		return _mm256_or_si256(_mm256_shuffle_epi8(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(mask<false>[ni].data()))),
+							   _mm256_shuffle_epi8(swapped, _mm256_load_si256(reinterpret_cast<const __m256i*>(mask<true>[ni].data()))));
+		#endif
+	}
+	#else
+	// lo: bytes 0-15, hi: bytes 16-31
+	static inline void permute(__m128i &lo, __m128i &hi, uint8_t ni) {
+		const __m128i *same = reinterpret_cast<const __m128i*>(mask<false>[ni].data());
+		const __m128i *cross = reinterpret_cast<const __m128i*>(mask<true>[ni].data());
+		const __m128i p_lo = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_load_si128(same)), _mm_shuffle_epi8(hi, _mm_load_si128(cross)));
+		hi = _mm_or_si128(_mm_shuffle_epi8(hi, _mm_load_si128(same+1)), _mm_shuffle_epi8(lo, _mm_load_si128(cross+1)));
+		lo = p_lo;
+	}
+	#endif
+};
+#endif /* __SSSE3__ */
+
+// dynamically permutate the key during iteration
+// key: permutated 32-byte key
+// ni: index of dynamic permutation number n
+// ni: iteration index
+template<typename Schedule>
+void FullTimePad::dynamic_permutation(uint8_t *key, uint8_t ni)
+{
+	static_assert(is_big_endian() || get_n_V<DefaultSchedule>() == n_V_little_endian, "n_V_little_endian doesn't match n_V_big_endian");
+
+	#if defined(__AVX2__)
+	__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(key), shuffle_kernel<Schedule>::permute(x, ni));
+	#elif defined(__SSSE3__)
+	__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+	__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key+16));
+	shuffle_kernel<Schedule>::permute(lo, hi, ni);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(key), lo);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(key+16), hi);
+	#else
+	static constexpr std::array<std::array<uint8_t, 32>, 16> n_V = get_n_V<Schedule>();
+
+	uint8_t p[keysize]; // dynamically re-purmutated key
+	for(uint8_t i=0;i<keysize;i+=4) {
+		// process multiple indexes at once. this is to make better use of parallelism in modern processors (4 operations happen simultaniously)
+		p[i] = key[n_V[ni][i]];
+		p[i+1] = key[n_V[ni][i+1]];
+		p[i+2] = key[n_V[ni][i+2]];
+		p[i+3] = key[n_V[ni][i+3]];
+	}
+	memcpy(key, p, keysize); // copy the repurmutated values
+	#endif
+}
+
+// dynamic permutations of one block: 16 in Version 1.0/1.1, 2 in Version 2.0
+template<FullTimePad::Version version>
+static constexpr uint64_t permutations = version == FullTimePad::Version20 ? 2 : 16;
+
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transformation(uint32_t *k, uint64_t encryption_index) // length of k is 8
+{
+	// permutate the key words, in registers when possible
+	rounds<version>(k, encryption_index, [](uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d, uint32_t &e, uint32_t &f, uint32_t &g, uint32_t &h, uint8_t ni) {
+		#ifdef __AVX2__
+		const __m256i x = shuffle_kernel<Schedule>::permute(_mm256_setr_epi32(a, b, c, d, e, f, g, h), ni);
+		a = _mm256_extract_epi32(x, 0);
+		b = _mm256_extract_epi32(x, 1);
+		c = _mm256_extract_epi32(x, 2);
+		d = _mm256_extract_epi32(x, 3);
+		e = _mm256_extract_epi32(x, 4);
+		f = _mm256_extract_epi32(x, 5);
+		g = _mm256_extract_epi32(x, 6);
+		h = _mm256_extract_epi32(x, 7);
+		#else
+		uint32_t key[8] = {a, b, c, d, e, f, g, h};
+		dynamic_permutation<Schedule>(reinterpret_cast<uint8_t*>(key), ni);
+		a = key[0];
+		b = key[1];
+		c = key[2];
+		d = key[3];
+		e = key[4];
+		f = key[5];
+		g = key[6];
+		h = key[7];
+		#endif
+	});
+
+	// counted, a probe per permutation would cost more than the shuffle
+	FULLTIMEPAD_COUNT(version, Permutation, permutations<version>, 0, permutations<version>*keysize);
+}
+
+// Version 1.0/1.1 rounds of transformation() on every lane of Kernel (avx2_kernel or avx512_kernel), each lane is a key
+// k: key words, A: A values of each lane with the encryption index in A[0] and A[1]
+template<FullTimePad::Version version, typename Kernel, typename Vector>
+inline void FullTimePad::lane_rounds(Vector *k, Vector *A)
+{
+	// the sum of the arguments % fp, the carries past 32 bits are counted in hi
+	auto mod_sum = [](Vector x, auto... rest) {
+		Vector hi = Kernel::zero();
+		(Kernel::add(x, hi, rest), ...);
+		return Kernel::mod_fp(x, hi);
+	};
+
+	auto single_iteration = [&]<uint8_t i>() {
+		constexpr uint8_t index = i<<2;
+		constexpr uint8_t i1mod = index % 8;
+		constexpr uint8_t i2mod = (index+1) % 8;
+		constexpr uint8_t i3mod = (index+2) % 8;
+		constexpr uint8_t i4mod = (index+3) % 8;
+		constexpr uint8_t imod8 = i % 8;
+		constexpr uint8_t imod9 = (i+1) % 8;
+		constexpr uint8_t rmod = i % 5; // 5 rotation values
+
+		k[i1mod] = mod_sum(k[i1mod], A[imod8], Kernel::template rotr<r[rmod]>(k[i1mod]));
+		const Vector sum = mod_sum(k[0], k[1], k[2], k[3], k[4], k[5], k[6], k[7]);
+
+		if constexpr(version == Version10) {
+			A[imod9] = Kernel::bit_xor(A[imod9], sum);
+			k[i2mod] = mod_sum(k[i2mod], A[imod9], Kernel::template rotl<r[rmod]>(k[i2mod]));
+			A[imod8] = Kernel::bit_xor(A[imod8], mod_sum(k[i2mod], Kernel::template rotr<r[(i+1)%5]>(k[i1mod])));
+			k[i3mod] = mod_sum(Kernel::bit_xor(A[imod8], k[i3mod]), Kernel::bit_xor(A[imod9], k[i4mod]));
+			k[i4mod] = mod_sum(Kernel::bit_xor(A[imod8], k[i4mod]), Kernel::bit_xor(A[imod9], k[i3mod]));
+		} else {
+			A[imod9] = mod_sum(Kernel::bit_xor(A[imod9], sum));
+			k[i2mod] = mod_sum(k[i2mod], A[imod9], Kernel::template rotl<r[rmod]>(k[i2mod]));
+			A[imod8] = mod_sum(Kernel::bit_xor(A[imod8], k[i2mod]));
+			k[i3mod] = mod_sum(Kernel::bit_xor(A[imod8], k[i3mod]));
+			k[i4mod] = mod_sum(Kernel::bit_xor(A[imod8], k[i4mod]));
+		}
+
+		// permutate the key
+		Kernel::template dynamic_permutation<i>(k);
+	};
+
+	// 16 iterations, unrolled
+	[&]<uint8_t... i>(std::integer_sequence<uint8_t, i...>) {
+		(single_iteration.template operator()<i>(), ...);
+	}(std::make_integer_sequence<uint8_t, 16>());
+}
+
+#ifdef __AVX2__
+// 8-way keystream kernel. Lane i of each vector holds the state of one block, either of the same key at encryption_index+i
+// or of 8 different keys, so every ARX operation of a round is done on 8 blocks with one instruction
+template<typename Schedule>
+struct FullTimePad::avx2_kernel
+{
+	static constexpr std::array<std::array<uint8_t, 32>, 16> n_V = get_n_V<Schedule>();
+
+	// bitwise right rotation of each 32-bit lane
+	template<uint8_t shift>
+	static inline __m256i rotr(__m256i x) {
+		return _mm256_or_si256(_mm256_srli_epi32(x, shift), _mm256_slli_epi32(x, 32 - shift));
+	}
+
+	// bitwise left rotation of each 32-bit lane
+	template<uint8_t shift>
+	static inline __m256i rotl(__m256i x) {
+		return _mm256_or_si256(_mm256_slli_epi32(x, shift), _mm256_srli_epi32(x, 32 - shift));
+	}
+
+	// lane-wise mod_fp for Version 1.0/1.1: 64-bit intermediates are kept as a 32-bit low word and a small high word (carry count)
+	// lo += x, counting the carry into hi
+	static inline void add(__m256i &lo, __m256i &hi, __m256i x) {
+		lo = _mm256_add_epi32(lo, x);
+		const __m256i carry = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(lo, x), lo), _mm256_set1_epi32(-1)); // lo < x
+		hi = _mm256_sub_epi32(hi, carry);
+	}
+
+	static inline __m256i zero() {
+		return _mm256_setzero_si256();
+	}
+
+	static inline __m256i bit_xor(__m256i x, __m256i y) {
+		return _mm256_xor_si256(x, y);
+	}
+
+	// (hi*2^32 + lo) % fp for hi < 2^29
+	static inline __m256i mod_fp(__m256i lo, __m256i hi) {
+		const __m256i five = _mm256_set1_epi32(5);
+		const __m256i fp_v = _mm256_set1_epi32(fp);
+		__m256i x = lo;
+		__m256i carry = _mm256_setzero_si256();
+		add(x, carry, _mm256_add_epi32(_mm256_slli_epi32(hi, 2), hi)); // lo + hi*5
+		x = _mm256_add_epi32(x, _mm256_and_si256(_mm256_sub_epi32(_mm256_setzero_si256(), carry), five)); // can't carry again
+		const __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(x, fp_v), x); // x >= fp
+		return _mm256_sub_epi32(x, _mm256_and_si256(ge, fp_v));
+	}
+
+	// check if word w gets any byte from word s in dynamic permutation ni
+	static consteval bool uses_word(uint8_t ni, uint8_t w, uint8_t s) {
+		for(uint8_t b=0;b<4;b++) {
+			if((n_V[ni][(w<<2) + b] >> 2) == s) return true;
+		}
+		return false;
+	}
+
+	// pshufb mask that moves the bytes word w takes from word s into place, in every lane. other bytes are zeroed
+	static consteval std::array<uint8_t, 32> permutation_mask(uint8_t ni, uint8_t w, uint8_t s) {
+		std::array<uint8_t, 32> mask{};
+		for(uint8_t lane=0;lane<8;lane++) {
+			for(uint8_t b=0;b<4;b++) {
+				const uint8_t src = n_V[ni][(w<<2) + b];
+				mask[(lane<<2) + b] = (src >> 2) == s ? ((lane&3)<<2) + (src&3) : 0x80; // pshufb stays in 128-bit lanes
+			}
+		}
+		return mask;
+	}
+
+	template<uint8_t ni, uint8_t w, uint8_t s>
+	static constexpr std::array<uint8_t, 32> mask = permutation_mask(ni, w, s);
+
+	// word w after dynamic permutation ni: one shuffle per source word it takes bytes from
+	template<uint8_t ni, uint8_t w, uint8_t... s>
+	static inline __m256i permute_word(const __m256i *x, std::integer_sequence<uint8_t, s...>) {
+		__m256i word = _mm256_setzero_si256();
+		((word = uses_word(ni, w, s) ? _mm256_or_si256(word, _mm256_shuffle_epi8(x[s], _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask<ni, w, s>.data())))) : word), ...);
+		return word;
+	}
+
+	// dynamically permutate the 8 keys in transposed layout
+	template<uint8_t ni, uint8_t... w>
+	static inline void dynamic_permutation(__m256i *x, std::integer_sequence<uint8_t, w...>) {
+		const __m256i p[8] = {permute_word<ni, w>(x, std::make_integer_sequence<uint8_t, 8>())...};
+		((x[w] = p[w]), ...);
+	}
+
+	template<uint8_t ni>
+	static inline void dynamic_permutation(__m256i *x) {
+		dynamic_permutation<ni>(x, std::make_integer_sequence<uint8_t, 8>());
+	}
+
+	// same as the Version 2.0 single_iteration of transformation(), on 8 lanes
+	template<uint8_t rmod>
+	static inline void single_iteration(__m256i &a, __m256i &b, __m256i &c, __m256i &d, __m256i &j, __m256i &l,
+										__m256i e, __m256i f, __m256i g, __m256i h) {
+		a = _mm256_add_epi32(a, _mm256_add_epi32(rotr<r[rmod]>(a), j));
+		__m256i sum = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(a, b), _mm256_add_epi32(c, d)),
+									   _mm256_add_epi32(_mm256_add_epi32(e, f), _mm256_add_epi32(g, h)));
+		l = _mm256_xor_si256(l, sum);
+		b = _mm256_add_epi32(b, _mm256_add_epi32(l, rotl<r[rmod]>(b)));
+		j = _mm256_xor_si256(j, b);
+		c = _mm256_xor_si256(c, j);
+		d = _mm256_xor_si256(d, j);
+	}
+
+	// 8x8 transpose of 32-bit words: 8 state words of 8 lanes <-> 8 blocks of 8 words
+	static inline void transpose(__m256i *x) {
+		__m256i t[8], u[8];
+		for(uint8_t i=0;i<8;i+=2) {
+			t[i] = _mm256_unpacklo_epi32(x[i], x[i+1]);
+			t[i+1] = _mm256_unpackhi_epi32(x[i], x[i+1]);
+		}
+		for(uint8_t i=0;i<8;i+=4) {
+			u[i] = _mm256_unpacklo_epi64(t[i], t[i+2]);
+			u[i+1] = _mm256_unpackhi_epi64(t[i], t[i+2]);
+			u[i+2] = _mm256_unpacklo_epi64(t[i+1], t[i+3]);
+			u[i+3] = _mm256_unpackhi_epi64(t[i+1], t[i+3]);
+		}
+		for(uint8_t i=0;i<4;i++) {
+			x[i] = _mm256_permute2x128_si256(u[i], u[i+4], 0x20);
+			x[i+4] = _mm256_permute2x128_si256(u[i], u[i+4], 0x31);
+		}
+	}
+
+	// one 32-byte block of keystream, XORed into the block at in when it's given. in == out (in-place) is fine
+	static inline void store_block(uint8_t *out, __m256i keystream, const uint8_t *in) {
+		if(in) keystream = _mm256_xor_si256(keystream, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), keystream);
+	}
+
+	// transpose the 8 state words back into 8 consecutive 32-byte blocks, XORed into the 8 blocks at in when it's given
+	static inline void store(uint8_t *out, const __m256i *x, const uint8_t *in = nullptr) {
+		__m256i blocks[8] = {x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]};
+		transpose(blocks);
+		for(uint8_t i=0;i<8;i++) {
+			store_block(out + (i<<5), blocks[i], in ? in + (i<<5) : nullptr);
+		}
+	}
+
+	// load 8 different 32-byte keys into the transposed layout, lane i is keys + 32*i in big endian words
+	static inline void load(__m256i *x, const uint8_t *keys) {
+		const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+											   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		for(uint8_t i=0;i<8;i++) {
+			x[i] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + (i<<5))), bswap);
+		}
+		transpose(x);
+	}
+
+	// the rounds of transformation() on 8 lanes
+	// x: key words, j and l: high and low words of the encryption index of each lane
+	template<Version version>
+	static inline void rounds(__m256i *x, __m256i j, __m256i l) {
+		if constexpr(version == Version20) {
+			// reset A values
+			__m256i m = _mm256_set1_epi32(0x119f904f);
+			__m256i n = _mm256_set1_epi32(0x73d44db5);
+			__m256i o = _mm256_set1_epi32(0x3918fa83);
+			__m256i q = _mm256_set1_epi32(0x5546b403);
+			__m256i s = _mm256_set1_epi32(0x216c46df);
+			__m256i t = _mm256_set1_epi32(0x64997dfd);
+
+			__m256i &a = x[0], &b = x[1], &c = x[2], &d = x[3], &e = x[4], &f = x[5], &g = x[6], &h = x[7];
+
+			// same schedule as Version 2.0 in transformation(): 10 rounds, 2 permutations
+			single_iteration<0>(a,b,c,d,j,l,e,f,g,h); // permutate
+			dynamic_permutation<0>(x);
+			single_iteration<1>(e,f,g,h,l,m,a,b,c,d);
+			single_iteration<2>(a,b,c,d,m,n,e,f,g,h);
+			single_iteration<3>(e,f,g,h,n,o,a,b,c,d);
+			single_iteration<4>(a,b,c,d,o,q,e,f,g,h); // permutate
+			dynamic_permutation<4>(x);
+			single_iteration<0>(e,f,g,h,q,s,a,b,c,d);
+			single_iteration<1>(a,b,c,d,s,t,e,f,g,h);
+			single_iteration<2>(e,f,g,h,t,j,a,b,c,d);
+			single_iteration<3>(a,b,c,d,j,l,e,f,g,h);
+			single_iteration<4>(e,f,g,h,l,m,a,b,c,d);
+		} else {
+			__m256i A[8] = {j, l, _mm256_set1_epi32(0x119f904f), _mm256_set1_epi32(0x73d44db5), _mm256_set1_epi32(0x3918fa83),
+							_mm256_set1_epi32(0x5546b403), _mm256_set1_epi32(0x216c46df), _mm256_set1_epi32(0x64997dfd)};
+			lane_rounds<version, avx2_kernel>(x, A);
+		}
+	}
+
+	// k: 32-bit words of the initial key in big endian
+	// in: 256 bytes of plaintext
+	// out: 256 bytes, in XOR the keystream of encryption_index to encryption_index+7. Either in itself or a buffer that doesn't overlap in
+	template<Version version>
+	static void transformation_x8(const uint32_t *k, uint64_t encryption_index, const uint8_t *in, uint8_t *out) {
+		__m256i x[8];
+		for(uint8_t i=0;i<8;i++) x[i] = _mm256_set1_epi32(k[i]);
+
+		// Incorporate the the encryption_index of each lane here
+		uint32_t hi[8], lo[8];
+		for(uint8_t i=0;i<8;i++) {
+			hi[i] = (encryption_index + i) >> 32;
+			lo[i] = encryption_index + i; // implicit & 0xffffffff
+		}
+		rounds<version>(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo)));
+		store(out, x, in);
+	}
+
+	// keys: 8 different 32-byte keys
+	// encryption_indexes: encryption index of each key
+	// out: 256 bytes, hash of each key
+	template<Version version>
+	static void hash_x8(const uint8_t *keys, const uint64_t *encryption_indexes, uint8_t *out) {
+		__m256i x[8];
+		load(x, keys);
+
+		uint32_t hi[8], lo[8];
+		for(uint8_t i=0;i<8;i++) {
+			hi[i] = encryption_indexes[i] >> 32;
+			lo[i] = encryption_indexes[i]; // implicit & 0xffffffff
+		}
+		rounds<version>(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo)));
+		store(out, x);
+	}
+};
+#endif /* __AVX2__ */
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VBMI__)
+// 16-way keystream kernel. Same transposed layout as avx2_kernel with 16 lanes per vector,
+// rotations are single vprold/vprord instructions and the dynamic permutations are vpermb/vpermi2b byte permutations
+template<typename Schedule>
+struct FullTimePad::avx512_kernel
+{
+	static constexpr std::array<std::array<uint8_t, 32>, 16> n_V = get_n_V<Schedule>();
+
+	// words that word w takes its bytes from in dynamic permutation ni, in order of first use
+	struct Sources {
+		uint8_t count = 0;
+		uint8_t word[4] = {};
+	};
+
+	static consteval Sources sources(uint8_t ni, uint8_t w) {
+		Sources src;
+		for(uint8_t b=0;b<4;b++) {
+			const uint8_t s = n_V[ni][(w<<2) + b] >> 2;
+			bool found = false;
+			for(uint8_t i=0;i<src.count;i++) found |= src.word[i] == s;
+			if(!found) src.word[src.count++] = s;
+		}
+		return src;
+	}
+
+	// vpermi2b index for the bytes word w takes from the source pair (word[pair*2], word[pair*2+1]).
+	// bit 6 selects the second table. bytes from the other pair are left 0, they are replaced by the blend
+	static consteval std::array<uint8_t, 64> permutation_index(uint8_t ni, uint8_t w, uint8_t pair) {
+		const Sources src = sources(ni, w);
+		std::array<uint8_t, 64> index{};
+		for(uint8_t lane=0;lane<16;lane++) {
+			for(uint8_t b=0;b<4;b++) {
+				const uint8_t byte = n_V[ni][(w<<2) + b];
+				for(uint8_t i=pair*2;i<pair*2+2 && i<src.count;i++) {
+					if(src.word[i] == (byte >> 2)) index[(lane<<2) + b] = ((i&1)<<6) | (lane<<2) | (byte&3);
+				}
+			}
+		}
+		return index;
+	}
+
+	// blend mask of the bytes that come from the second source pair
+	static consteval uint64_t blend_mask(uint8_t ni, uint8_t w) {
+		const Sources src = sources(ni, w);
+		uint64_t mask = 0;
+		for(uint8_t lane=0;lane<16;lane++) {
+			for(uint8_t b=0;b<4;b++) {
+				const uint8_t s = n_V[ni][(w<<2) + b] >> 2;
+				if(src.count > 2 && (s == src.word[2] || (src.count > 3 && s == src.word[3]))) mask |= 1ULL << ((lane<<2) + b);
+			}
+		}
+		return mask;
+	}
+
+	template<uint8_t ni, uint8_t w, uint8_t pair>
+	static constexpr std::array<uint8_t, 64> index = permutation_index(ni, w, pair);
+
+	// gather the bytes of one source pair (or a single source) into place
+	template<uint8_t ni, uint8_t w, uint8_t pair>
+	static inline __m512i permute_pair(const __m512i *x) {
+		constexpr Sources src = sources(ni, w);
+		const __m512i idx = _mm512_loadu_si512(index<ni, w, pair>.data());
+		if constexpr(src.count == pair*2 + 1) {
+			return _mm512_permutexvar_epi8(idx, x[src.word[pair*2]]); // vpermb
+		} else {
+			return _mm512_permutex2var_epi8(x[src.word[pair*2]], idx, x[src.word[pair*2 + 1]]); // vpermi2b
+		}
+	}
+
+	// word w after dynamic permutation ni
+	template<uint8_t ni, uint8_t w>
+	static inline __m512i permute_word(const __m512i *x) {
+		constexpr Sources src = sources(ni, w);
+		if constexpr(src.count <= 2) {
+			return permute_pair<ni, w, 0>(x);
+		} else {
+			// named first, GCC defines the blend as a macro without optimization and the template commas would split its arguments
+			const __m512i first = permute_pair<ni, w, 0>(x), second = permute_pair<ni, w, 1>(x);
+			return _mm512_mask_blend_epi8(blend_mask(ni, w), first, second);
+		}
+	}
+
+	// dynamically permutate the 16 keys in transposed layout
+	template<uint8_t ni, uint8_t... w>
+	static inline void dynamic_permutation(__m512i *x, std::integer_sequence<uint8_t, w...>) {
+		const __m512i p[8] = {permute_word<ni, w>(x)...};
+		((x[w] = p[w]), ...);
+	}
+
+	template<uint8_t ni>
+	static inline void dynamic_permutation(__m512i *x) {
+		dynamic_permutation<ni>(x, std::make_integer_sequence<uint8_t, 8>());
+	}
+
+	// bitwise right rotation of each 32-bit lane
+	template<uint8_t shift>
+	static inline __m512i rotr(__m512i x) {
+		return _mm512_ror_epi32(x, shift);
+	}
+
+	// bitwise left rotation of each 32-bit lane
+	template<uint8_t shift>
+	static inline __m512i rotl(__m512i x) {
+		return _mm512_rol_epi32(x, shift);
+	}
+
+	static inline __m512i zero() {
+		return _mm512_setzero_si512();
+	}
+
+	static inline __m512i bit_xor(__m512i x, __m512i y) {
+		return _mm512_xor_si512(x, y);
+	}
+
+	// lane-wise mod_fp for Version 1.0/1.1, same as avx2_kernel
+	// lo += x, counting the carry into hi
+	static inline void add(__m512i &lo, __m512i &hi, __m512i x) {
+		lo = _mm512_add_epi32(lo, x);
+		hi = _mm512_mask_add_epi32(hi, _mm512_cmplt_epu32_mask(lo, x), hi, _mm512_set1_epi32(1));
+	}
+
+	// (hi*2^32 + lo) % fp for hi < 2^29
+	static inline __m512i mod_fp(__m512i lo, __m512i hi) {
+		const __m512i five = _mm512_set1_epi32(5);
+		const __m512i fp_v = _mm512_set1_epi32(fp);
+		__m512i x = _mm512_add_epi32(lo, _mm512_add_epi32(_mm512_slli_epi32(hi, 2), hi)); // lo + hi*5
+		x = _mm512_mask_add_epi32(x, _mm512_cmplt_epu32_mask(x, lo), x, five); // can't carry again
+		return _mm512_mask_sub_epi32(x, _mm512_cmpge_epu32_mask(x, fp_v), x, fp_v);
+	}
+
+	// same as the Version 2.0 single_iteration of transformation(), on 16 lanes
+	template<uint8_t rmod>
+	static inline void single_iteration(__m512i &a, __m512i &b, __m512i &c, __m512i &d, __m512i &j, __m512i &l,
+										__m512i e, __m512i f, __m512i g, __m512i h) {
+		a = _mm512_add_epi32(a, _mm512_add_epi32(rotr<r[rmod]>(a), j));
+		__m512i sum = _mm512_add_epi32(_mm512_add_epi32(_mm512_add_epi32(a, b), _mm512_add_epi32(c, d)),
+									   _mm512_add_epi32(_mm512_add_epi32(e, f), _mm512_add_epi32(g, h)));
+		l = _mm512_xor_si512(l, sum);
+		b = _mm512_add_epi32(b, _mm512_add_epi32(l, rotl<r[rmod]>(b)));
+		j = _mm512_xor_si512(j, b);
+		c = _mm512_xor_si512(c, j);
+		d = _mm512_xor_si512(d, j);
+	}
+
+	// transpose the 8 state words back into 16 consecutive 32-byte blocks, XORed into the 16 blocks at in when it's given
+	static inline void store(uint8_t *out, const __m512i *x, const uint8_t *in = nullptr) {
+		__m512i t[8], u[8];
+		for(uint8_t i=0;i<8;i+=2) {
+			t[i] = _mm512_unpacklo_epi32(x[i], x[i+1]);
+			t[i+1] = _mm512_unpackhi_epi32(x[i], x[i+1]);
+		}
+		for(uint8_t i=0;i<8;i+=4) {
+			u[i] = _mm512_unpacklo_epi64(t[i], t[i+2]);
+			u[i+1] = _mm512_unpackhi_epi64(t[i], t[i+2]);
+			u[i+2] = _mm512_unpacklo_epi64(t[i+1], t[i+3]);
+			u[i+3] = _mm512_unpackhi_epi64(t[i+1], t[i+3]);
+		}
+
+		// 128-bit lane L of u[m] is the first half of block 4L+m, u[m+4] has the second half
+		const __m512i lo = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+		const __m512i hi = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+		for(uint8_t m=0;m<4;m++) {
+			const __m512i blocks_lo = _mm512_permutex2var_epi64(u[m], lo, u[m+4]); // blocks m, m+4
+			const __m512i blocks_hi = _mm512_permutex2var_epi64(u[m], hi, u[m+4]); // blocks m+8, m+12
+			const uint8_t b[4] = {m, uint8_t(m+4), uint8_t(m+8), uint8_t(m+12)};
+			const __m256i keystream[4] = {_mm512_castsi512_si256(blocks_lo), _mm512_extracti64x4_epi64(blocks_lo, 1),
+										  _mm512_castsi512_si256(blocks_hi), _mm512_extracti64x4_epi64(blocks_hi, 1)};
+			for(uint8_t i=0;i<4;i++) {
+				avx2_kernel<Schedule>::store_block(out + (b[i]<<5), keystream[i], in ? in + (b[i]<<5) : nullptr);
+			}
+		}
+	}
+
+	// the rounds of transformation() on 16 lanes
+	// x: key words, j and l: high and low words of the encryption index of each lane
+	template<Version version>
+	static inline void rounds(__m512i *x, __m512i j, __m512i l) {
+		if constexpr(version == Version20) {
+			// reset A values
+			__m512i m = _mm512_set1_epi32(0x119f904f);
+			__m512i n = _mm512_set1_epi32(0x73d44db5);
+			__m512i o = _mm512_set1_epi32(0x3918fa83);
+			__m512i q = _mm512_set1_epi32(0x5546b403);
+			__m512i s = _mm512_set1_epi32(0x216c46df);
+			__m512i t = _mm512_set1_epi32(0x64997dfd);
+
+			__m512i &a = x[0], &b = x[1], &c = x[2], &d = x[3], &e = x[4], &f = x[5], &g = x[6], &h = x[7];
+
+			// same schedule as Version 2.0 in transformation(): 10 rounds, 2 permutations
+			single_iteration<0>(a,b,c,d,j,l,e,f,g,h); // permutate
+			dynamic_permutation<0>(x);
+			single_iteration<1>(e,f,g,h,l,m,a,b,c,d);
+			single_iteration<2>(a,b,c,d,m,n,e,f,g,h);
+			single_iteration<3>(e,f,g,h,n,o,a,b,c,d);
+			single_iteration<4>(a,b,c,d,o,q,e,f,g,h); // permutate
+			dynamic_permutation<4>(x);
+			single_iteration<0>(e,f,g,h,q,s,a,b,c,d);
+			single_iteration<1>(a,b,c,d,s,t,e,f,g,h);
+			single_iteration<2>(e,f,g,h,t,j,a,b,c,d);
+			single_iteration<3>(a,b,c,d,j,l,e,f,g,h);
+			single_iteration<4>(e,f,g,h,l,m,a,b,c,d);
+		} else {
+			__m512i A[8] = {j, l, _mm512_set1_epi32(0x119f904f), _mm512_set1_epi32(0x73d44db5), _mm512_set1_epi32(0x3918fa83),
+							_mm512_set1_epi32(0x5546b403), _mm512_set1_epi32(0x216c46df), _mm512_set1_epi32(0x64997dfd)};
+			lane_rounds<version, avx512_kernel>(x, A);
+		}
+	}
+
+	// high and low words of 16 encryption indexes, given as two vectors of 8
+	static inline void split_index(__m512i index_lo, __m512i index_hi, __m512i &j, __m512i &l) {
+		const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+		const __m512i odd = _mm512_add_epi32(even, _mm512_set1_epi32(1));
+		j = _mm512_permutex2var_epi32(index_lo, odd, index_hi); // encryption_index >> 32
+		l = _mm512_permutex2var_epi32(index_lo, even, index_hi); // encryption_index & 0xffffffff
+	}
+
+	// k: 32-bit words of the initial key in big endian
+	// in: 512 bytes of plaintext
+	// out: 512 bytes, in XOR the keystream of encryption_index to encryption_index+15. Either in itself or a buffer that doesn't overlap in
+	template<Version version>
+	static void transformation_x16(const uint32_t *k, uint64_t encryption_index, const uint8_t *in, uint8_t *out) {
+		__m512i x[8];
+		for(uint8_t i=0;i<8;i++) x[i] = _mm512_set1_epi32(k[i]);
+
+		// Incorporate the the encryption_index of each lane here
+		const __m512i lane = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m512i index_lo = _mm512_add_epi64(_mm512_set1_epi64(encryption_index), lane);
+		const __m512i index_hi = _mm512_add_epi64(index_lo, _mm512_set1_epi64(8));
+		__m512i j, l;
+		split_index(index_lo, index_hi, j, l);
+
+		rounds<version>(x, j, l);
+		store(out, x, in);
+	}
+
+	// keys: 16 different 32-byte keys
+	// encryption_indexes: encryption index of each key
+	// out: 512 bytes, hash of each key
+	template<Version version>
+	static void hash_x16(const uint8_t *keys, const uint64_t *encryption_indexes, uint8_t *out) {
+		// lanes 0-7 and 8-15 are transposed as two halves
+		__m256i lo[8], hi[8];
+		avx2_kernel<Schedule>::load(lo, keys);
+		avx2_kernel<Schedule>::load(hi, keys + 256);
+		__m512i x[8];
+		for(uint8_t i=0;i<8;i++) x[i] = _mm512_mask_broadcast_i64x4(_mm512_maskz_broadcast_i64x4(0x0f, lo[i]), 0xf0, hi[i]);
+
+		__m512i j, l;
+		split_index(_mm512_loadu_si512(encryption_indexes), _mm512_loadu_si512(encryption_indexes + 8), j, l);
+
+		rounds<version>(x, j, l);
+		store(out, x);
+	}
+};
+#endif /* __AVX512F__ && __AVX512BW__ && __AVX512VBMI__ */
+
+// key: 256-bit (32-byte) key, should be allocated with length keysize
+// key should be empty as it's only a place holder for the transformed init_k
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::hash(uint8_t *key, uint64_t encryption_index)
+{
+	// 32-bit array ints for key for arithmetic ARX manipulations, init_k is preserved
+	std::array<uint32_t, 8> k = init_k;
+
+	// transformation iterations
+	FULLTIMEPAD_PROBE(version, Transformation, 1, keysize);
+	transformation<version, Schedule>(k.data(), encryption_index);
+	memcpy(key, k.data(), keysize);
+	explicit_bzero(k.data(), keysize);
+}
+
+// hash of n different keys, up to 16 keys at once in the SIMD lanes
+// keys: n 32-byte keys, one after another
+// encryption_indexes: n encryption indexes, one per key
+// out: n*32 bytes, block i is the hash of key i at encryption_indexes[i]
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::hash_many(const uint8_t *keys, const uint64_t *encryption_indexes, uint8_t *out, size_t n)
+{
+	size_t i=0;
+
+	// timed here as a whole, a probe inside the inlined kernels would put its calls into their vector code
+	FULLTIMEPAD_PROBE(version, Transformation, n, n*keysize);
+
+	#ifdef __AVX2__
+	FULLTIMEPAD_COUNT(version, Permutation, permutations<version>*n, 0, permutations<version>*n*keysize);
+	#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VBMI__)
+	for(;i+16<=n;i+=16) {
+		avx512_kernel<Schedule>::template hash_x16<version>(keys + i*keysize, encryption_indexes + i, out + i*keysize);
+	}
+	#endif
+	for(;i+8<=n;i+=8) {
+		avx2_kernel<Schedule>::template hash_x8<version>(keys + i*keysize, encryption_indexes + i, out + i*keysize);
+	}
+
+	// the last keys are padded to 8 lanes, all 8 cost about as much as a single block
+	if(i < n) {
+		uint8_t lane_keys[keysize*8] = {};
+		uint64_t lane_indexes[8] = {};
+		uint8_t lane_out[keysize*8];
+		memcpy(lane_keys, keys + i*keysize, (n-i)*keysize);
+		memcpy(lane_indexes, encryption_indexes + i, (n-i)*sizeof(uint64_t));
+		avx2_kernel<Schedule>::template hash_x8<version>(lane_keys, lane_indexes, lane_out);
+		memcpy(out + i*keysize, lane_out, (n-i)*keysize);
+		explicit_bzero(lane_keys, sizeof(lane_keys));
+		explicit_bzero(lane_out, sizeof(lane_out));
+	}
+	#else
+	for(;i<n;i++) {
+		std::array<uint32_t, 8> k;
+		load_key(k.data(), keys + i*keysize);
+		transformation<version, Schedule>(k.data(), encryption_indexes[i]);
+		memcpy(out + i*keysize, k.data(), keysize);
+		explicit_bzero(k.data(), keysize);
+	}
+	#endif
+}
+
+// encrypt/decrypt one block of up to 32 bytes without a keystream buffer
+// in: plaintext data
+// out: ciphertext data, either in itself (in-place) or a buffer that doesn't overlap in
+// length: length of in, and out. At most keysize
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transform_block(const uint8_t *in, uint8_t *out, uint8_t length, uint64_t encryption_index)
+{
+	std::array<uint32_t, 8> k = init_k;
+	{
+		FULLTIMEPAD_PROBE(version, Transformation, 1, keysize);
+		transformation<version, Schedule>(k.data(), encryption_index);
+	}
+	FULLTIMEPAD_PROBE(version, Xor, 0, length);
+
+	// the output bytes are the native representation of k
+	#ifdef __AVX2__
+	const __m256i keystream = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k.data()));
+	if(length == keysize) {
+		const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_xor_si256(x, keystream));
+	}
+	else {
+		#if defined(__AVX512BW__) && defined(__AVX512VL__)
+		// masked bytes aren't read or written, so the tail can end at the last byte of a page
+		const __mmask32 mask = (uint32_t(1) << length) - 1; // length < 32
+		const __m256i x = _mm256_maskz_loadu_epi8(mask, in);
+		_mm256_mask_storeu_epi8(out, mask, _mm256_xor_si256(x, keystream));
+		#else
+		const uint8_t *key = reinterpret_cast<const uint8_t*>(k.data());
+		for(uint8_t j=0;j<length;j++) {
+			out[j] = in[j] ^ key[j];
+		}
+		#endif
+	}
+	#else
+	if(length == keysize) {
+		uint64_t x[4], key[4];
+		memcpy(x, in, keysize);
+		memcpy(key, k.data(), keysize);
+		for(uint8_t j=0;j<4;j++) x[j] ^= key[j];
+		memcpy(out, x, keysize);
+	}
+	else {
+		const uint8_t *key = reinterpret_cast<const uint8_t*>(k.data());
+		for(uint8_t j=0;j<length;j++) {
+			out[j] = in[j] ^ key[j];
+		}
+	}
+	#endif
+	explicit_bzero(k.data(), keysize);
+}
+
+// encrypt/decrypt
+// pt: plaintext data
+// ct: ciphertext data, either pt itself (in-place) or a buffer that doesn't overlap pt
+// length: length of pt, and ct
+// encryption_index: encryption index
+// version: version of encryption algorithm (1.0, 1.1, 2.0)
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transform(const uint8_t *pt, uint8_t *ct, size_t length, uint64_t encryption_index)
+{
+	// generate unieqe key based on encryption index and encrypt
+	// for each 32-byte segment of the plaintext
+	const size_t segment = length/32;
+	size_t i=0;
+
+	#ifdef __AVX2__
+	if(segment >= 8) {
+		// 16 or 8 segments at once, the lanes only differ by encryption index. The keystream is XORed into ct straight from the
+		// registers, it never goes through memory. Timed as a whole like in hash_many
+		[[maybe_unused]] const size_t blocks = segment & ~size_t(7);
+		FULLTIMEPAD_PROBE(version, Transformation, blocks, blocks*keysize);
+		FULLTIMEPAD_COUNT(version, Permutation, permutations<version>*blocks, 0, permutations<version>*blocks*keysize);
+		FULLTIMEPAD_COUNT(version, Xor, 1, 0, blocks*keysize);
+
+		#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VBMI__)
+		for(;i+16<=segment;i+=16) {
+			avx512_kernel<Schedule>::template transformation_x16<version>(init_k.data(), encryption_index, pt, ct);
+			pt += keysize*16;
+			ct += keysize*16;
+			encryption_index += 16;
+		}
+		#endif
+
+		for(;i+8<=segment;i+=8) {
+			avx2_kernel<Schedule>::template transformation_x8<version>(init_k.data(), encryption_index, pt, ct);
+			pt += keysize*8;
+			ct += keysize*8;
+			encryption_index += 8;
+		}
+	}
+	#endif
+
+	for(;i<segment;i++) {
+		transform_block<version, Schedule>(pt, ct, keysize, encryption_index); // incorporate encryption index
+		pt += keysize;
+		ct += keysize;
+		encryption_index++;
+	}
+
+	// for the remainder:
+	const uint8_t final_length = length%32;
+	if (final_length != 0) {
+		transform_block<version, Schedule>(pt, ct, final_length, encryption_index); // incorporate encryption index
+	}
+}
+
+// encrypt/decrypt
+// pt: plaintext data
+// ct: ciphertext data, same size as pt. Either pt itself (in-place) or a buffer that doesn't overlap pt
+// encryption_index: encryption index
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transform(std::span<const std::byte> pt, std::span<std::byte> ct, uint64_t encryption_index)
+{
+	assert(pt.size() == ct.size());
+	transform<version, Schedule>(reinterpret_cast<const uint8_t*>(pt.data()), reinterpret_cast<uint8_t*>(ct.data()), pt.size(), encryption_index);
+}
+
+// encrypt/decrypt data in-place
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transform(std::span<std::byte> data, uint64_t encryption_index)
+{
+	transform<version, Schedule>(reinterpret_cast<const uint8_t*>(data.data()), reinterpret_cast<uint8_t*>(data.data()), data.size(), encryption_index);
+}
+
+// encrypt/decrypt on all threads of pool. Same output as transform
+// pt: plaintext data
+// ct: ciphertext data, either pt itself (in-place) or a buffer that doesn't overlap pt
+// length: length of pt, and ct
+// encryption_index: encryption index of the first 32-byte segment
+// pool: threads to use
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::parallel_transform(const uint8_t *pt, uint8_t *ct, size_t length, uint64_t encryption_index, ThreadPool &pool)
+{
+	// each chunk starts at a 32-byte segment, so its encryption index is encryption_index + offset/32
+	const size_t chunks = (length + parallel_chunk - 1) / parallel_chunk;
+	pool.parallel_for(chunks, [&](size_t chunk) {
+		const size_t offset = chunk * parallel_chunk;
+		const size_t chunk_length = std::min(parallel_chunk, length - offset);
+		transform<version, Schedule>(pt + offset, ct + offset, chunk_length, encryption_index + offset/keysize);
+	});
+}
+
+// encrypt/decrypt on all threads of pool
+// pt: plaintext data
+// ct: ciphertext data, same size as pt. Either pt itself (in-place) or a buffer that doesn't overlap pt
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::parallel_transform(std::span<const std::byte> pt, std::span<std::byte> ct, uint64_t encryption_index, ThreadPool &pool)
+{
+	assert(pt.size() == ct.size());
+	parallel_transform<version, Schedule>(reinterpret_cast<const uint8_t*>(pt.data()), reinterpret_cast<uint8_t*>(ct.data()), pt.size(), encryption_index, pool);
+}
+
+// encrypt/decrypt data in-place on all threads of pool
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::parallel_transform(std::span<std::byte> data, uint64_t encryption_index, ThreadPool &pool)
+{
+	parallel_transform<version, Schedule>(reinterpret_cast<const uint8_t*>(data.data()), reinterpret_cast<uint8_t*>(data.data()), data.size(), encryption_index, pool);
+}
+
+// encrypt/decrypt the byte range [offset, offset+length) of a message
+// in: message bytes from offset on
+// out: output, either in itself (in-place) or a buffer that doesn't overlap in
+// offset: offset of in within the message
+// length: length of in, and out
+// encryption_index: encryption index of the whole message
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transform_range(const uint8_t *in, uint8_t *out, uint64_t offset, size_t length, uint64_t encryption_index)
+{
+	// byte offset uses the keystream of block offset/32 from byte offset%32 on
+	encryption_index += offset/keysize;
+	const uint8_t head = offset%keysize;
+
+	// partial first block
+	if(head != 0 && length != 0) {
+		uint8_t keystream[keysize];
+		hash<version, Schedule>(keystream, encryption_index++);
+		const uint8_t n = std::min<size_t>(length, keysize - head);
+		for(uint8_t j=0;j<n;j++) {
+			out[j] = in[j] ^ keystream[head+j];
+		}
+		explicit_bzero(keystream, keysize);
+		in += n;
+		out += n;
+		length -= n;
+	}
+
+	// the rest starts at a block boundary, transform handles the partial last block
+	transform<version, Schedule>(in, out, length, encryption_index);
+}
+
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transform_range(std::span<const std::byte> in, std::span<std::byte> out, uint64_t offset, uint64_t encryption_index)
+{
+	assert(in.size() == out.size());
+	transform_range<version, Schedule>(reinterpret_cast<const uint8_t*>(in.data()), reinterpret_cast<uint8_t*>(out.data()), offset, in.size(), encryption_index);
+}
+
+// transform_range for every range of a message
+template<FullTimePad::Version version, typename Schedule>
+void FullTimePad::transform_ranges(std::span<const Range> ranges, uint64_t encryption_index)
+{
+	for(const Range &range : ranges) {
+		transform_range<version, Schedule>(range.in, range.out, range.offset, range.length, encryption_index);
+	}
+}
+
+#endif /* FULLTIMEPAD_KERNELS_H */
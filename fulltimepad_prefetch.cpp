@@ -0,0 +1,129 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef FULLTIMEPAD_PREFETCH_CPP
+#define FULLTIMEPAD_PREFETCH_CPP
+
+#include <algorithm>
+#include <bit>
+
+#include "fulltimepad_prefetch.h"
+
+// fulltimepad: keyed cipher, has to outlive the prefetcher
+// encryption_index: encryption index of the first message
+// capacity: keystream blocks kept ready, rounded up to a power of 2
+// low_water: the producer refills once no more than low_water blocks are ready, capacity/2 if 0
+template<FullTimePad::Version version>
+FullTimePadPrefetch<version>::FullTimePadPrefetch(FullTimePad &fulltimepad, uint64_t encryption_index, size_t capacity, size_t low_water)
+	: fulltimepad(fulltimepad), first_index(encryption_index), capacity(std::bit_ceil(std::max<size_t>(capacity, 2))),
+	  low_water(low_water == 0 || low_water >= this->capacity ? this->capacity/2 : low_water),
+	  ring(new uint8_t[this->capacity*FullTimePad::keysize])
+{
+	producer = std::thread(&FullTimePadPrefetch::produce, this);
+}
+
+// producer thread loop
+template<FullTimePad::Version version>
+void FullTimePadPrefetch<version>::produce()
+{
+	uint64_t h = head.load(std::memory_order_relaxed);
+	while(!stop.load(std::memory_order_acquire)) {
+		const size_t free = capacity - (h - tail.load(std::memory_order_acquire));
+		if(free == 0) {
+			// full: sleep until the consumer drains the ring to the low-water mark.
+			// sleeping and tail are seq_cst so either this sees the new tail or the consumer sees sleeping
+			const uint32_t w = wake.load(std::memory_order_acquire);
+			sleeping.store(true);
+			if(h - tail.load() > low_water && !stop.load()) {
+				wake.wait(w);
+			}
+			sleeping.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		// generate up to batch blocks in place, without wrapping around the end of the ring
+		const size_t n = std::min({free, batch, capacity - (h & (capacity-1))});
+		uint8_t *block = ring.get() + (h & (capacity-1))*FullTimePad::keysize;
+		memset(block, 0, n*FullTimePad::keysize);
+		fulltimepad.transform<version>(block, block, n*FullTimePad::keysize, first_index + h);
+
+		h += n;
+		head.store(h, std::memory_order_release);
+		head.notify_one();
+	}
+}
+
+// encrypt/decrypt the next message with prefetched keystream
+// in: plaintext data
+// out: ciphertext data, either in itself (in-place) or a buffer that doesn't overlap in
+// length: length of in, and out
+// returns the encryption index of the message
+template<FullTimePad::Version version>
+uint64_t FullTimePadPrefetch<version>::transform(const uint8_t *in, uint8_t *out, size_t length)
+{
+	uint64_t t = tail.load(std::memory_order_relaxed);
+	const uint64_t encryption_index = first_index + t;
+
+	while(length != 0) {
+		// wait for the producer only if the ring ran empty
+		uint64_t h = head.load(std::memory_order_acquire);
+		if(h == t) {
+			head.wait(t, std::memory_order_acquire);
+			h = head.load(std::memory_order_acquire);
+		}
+
+		// XOR every ready block of the message, the used keystream is wiped
+		for(;t<h && length!=0;t++) {
+			uint8_t *block = ring.get() + (t & (capacity-1))*FullTimePad::keysize;
+			const size_t n = std::min<size_t>(length, FullTimePad::keysize);
+			for(size_t j=0;j<n;j++) {
+				out[j] = in[j] ^ block[j];
+			}
+			explicit_bzero(block, FullTimePad::keysize);
+			in += n;
+			out += n;
+			length -= n;
+		}
+
+		// hand the blocks back and wake the producer at the low-water mark
+		tail.store(t);
+		if(sleeping.load() && h - t <= low_water) {
+			wake.fetch_add(1, std::memory_order_release);
+			wake.notify_one();
+		}
+	}
+	return encryption_index;
+}
+
+// Destructor, stops the producer and wipes the ring
+template<FullTimePad::Version version>
+FullTimePadPrefetch<version>::~FullTimePadPrefetch()
+{
+	stop.store(true);
+	wake.fetch_add(1, std::memory_order_release);
+	wake.notify_one();
+	producer.join();
+	explicit_bzero(ring.get(), capacity*FullTimePad::keysize);
+}
+
+// Explicit instantiation
+template class FullTimePadPrefetch<FullTimePad::Version10>;
+template class FullTimePadPrefetch<FullTimePad::Version11>;
+template class FullTimePadPrefetch<FullTimePad::Version20>;
+
+#endif /* FULLTIMEPAD_PREFETCH_CPP */
@@ -0,0 +1,87 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef FULLTIMEPAD_PREFETCH_H
+#define FULLTIMEPAD_PREFETCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "fulltimepad.h"
+
+// keystream generated ahead of time by a producer thread, so encrypting a message on the calling thread only XORs.
+// Blocks for consecutive encryption indexes go through a lock-free single-producer/single-consumer ring,
+// the producer sleeps when the ring is full and is woken when it drains to the low-water mark.
+// Only one thread may call transform
+template<FullTimePad::Version version=FullTimePad::Version10>
+class FullTimePadPrefetch
+{
+	private:
+			FullTimePad &fulltimepad;
+
+			// encryption index of ring block 0
+			const uint64_t first_index;
+
+			// ring of capacity keystream blocks, capacity is a power of 2
+			const size_t capacity;
+			const size_t low_water;
+			std::unique_ptr<uint8_t[]> ring;
+
+			// blocks produced and consumed since the start, on their own cache lines
+			alignas(64) std::atomic<uint64_t> head{0};
+			alignas(64) std::atomic<uint64_t> tail{0};
+
+			// producer sleeps on wake while sleeping is set
+			alignas(64) std::atomic<uint32_t> wake{0};
+			std::atomic<bool> sleeping{false};
+			std::atomic<bool> stop{false};
+
+			std::thread producer;
+
+			// blocks the producer generates before publishing them
+			static constexpr size_t batch = 16;
+
+			// producer thread loop
+			void produce();
+
+	public:
+			// fulltimepad: keyed cipher, has to outlive the prefetcher
+			// encryption_index: encryption index of the first message
+			// capacity: keystream blocks kept ready, rounded up to a power of 2
+			// low_water: the producer refills once no more than low_water blocks are ready, capacity/2 if 0
+			FullTimePadPrefetch(FullTimePad &fulltimepad, uint64_t encryption_index, size_t capacity = 1024, size_t low_water = 0);
+
+			FullTimePadPrefetch(const FullTimePadPrefetch &) = delete;
+			FullTimePadPrefetch &operator=(const FullTimePadPrefetch &) = delete;
+
+			// encrypt/decrypt the next message with prefetched keystream
+			// in: plaintext data
+			// out: ciphertext data, either in itself (in-place) or a buffer that doesn't overlap in
+			// length: length of in, and out
+			// returns the encryption index of the message, the output is the same as
+			// FullTimePad::transform with that index. The message uses (length+31)/32 encryption indexes
+			uint64_t transform(const uint8_t *in, uint8_t *out, size_t length);
+
+			// Destructor, stops the producer and wipes the ring
+			~FullTimePadPrefetch();
+};
+
+#endif /* FULLTIMEPAD_PREFETCH_H */
@@ -0,0 +1,103 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef FULLTIMEPAD_STREAM_CPP
+#define FULLTIMEPAD_STREAM_CPP
+
+#include <algorithm>
+
+#include "fulltimepad_stream.h"
+
+// fulltimepad: keyed cipher, has to outlive the stream
+// encryption_index: encryption index of the first 32-byte segment of the message
+template<FullTimePad::Version version>
+FullTimePadStream<version>::FullTimePadStream(FullTimePad &fulltimepad, uint64_t encryption_index) : fulltimepad(fulltimepad), encryption_index(encryption_index)
+{
+}
+
+// encrypt/decrypt the next length bytes of the message
+// in: plaintext data
+// out: ciphertext data, either in itself (in-place) or a buffer that doesn't overlap in
+template<FullTimePad::Version version>
+void FullTimePadStream<version>::update(const uint8_t *in, uint8_t *out, size_t length)
+{
+	// finish the keystream block left over from the previous update
+	const size_t carry = std::min<size_t>(length, FullTimePad::keysize - offset);
+	for(size_t j=0;j<carry;j++) {
+		out[j] = in[j] ^ keystream[offset+j];
+	}
+	offset += carry;
+	in += carry;
+	out += carry;
+	length -= carry;
+
+	// whole segments go through the bulk transform
+	const size_t segments = length/FullTimePad::keysize;
+	fulltimepad.transform<version>(in, out, segments*FullTimePad::keysize, encryption_index);
+	encryption_index += segments;
+	in += segments*FullTimePad::keysize;
+	out += segments*FullTimePad::keysize;
+	length -= segments*FullTimePad::keysize;
+
+	// start a new block for the remainder and keep the rest of it
+	if(length != 0) {
+		fulltimepad.hash<version>(keystream, encryption_index++);
+		for(size_t j=0;j<length;j++) {
+			out[j] = in[j] ^ keystream[j];
+		}
+		offset = length;
+	}
+}
+
+// encrypt/decrypt the next in.size() bytes of the message, out has the same size as in
+template<FullTimePad::Version version>
+void FullTimePadStream<version>::update(std::span<const std::byte> in, std::span<std::byte> out)
+{
+	assert(in.size() == out.size());
+	update(reinterpret_cast<const uint8_t*>(in.data()), reinterpret_cast<uint8_t*>(out.data()), in.size());
+}
+
+// encrypt/decrypt the next data.size() bytes of the message in-place
+template<FullTimePad::Version version>
+void FullTimePadStream<version>::update(std::span<std::byte> data)
+{
+	update(reinterpret_cast<const uint8_t*>(data.data()), reinterpret_cast<uint8_t*>(data.data()), data.size());
+}
+
+// end of message, wipes the keystream. returns the encryption index after the last segment used
+template<FullTimePad::Version version>
+uint64_t FullTimePadStream<version>::final()
+{
+	explicit_bzero(keystream, FullTimePad::keysize);
+	offset = FullTimePad::keysize;
+	return encryption_index;
+}
+
+// Destructor
+template<FullTimePad::Version version>
+FullTimePadStream<version>::~FullTimePadStream()
+{
+	explicit_bzero(keystream, FullTimePad::keysize);
+}
+
+// Explicit instantiation
+template class FullTimePadStream<FullTimePad::Version10>;
+template class FullTimePadStream<FullTimePad::Version11>;
+template class FullTimePadStream<FullTimePad::Version20>;
+
+#endif /* FULLTIMEPAD_STREAM_CPP */
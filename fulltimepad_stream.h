@@ -0,0 +1,71 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef FULLTIMEPAD_STREAM_H
+#define FULLTIMEPAD_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <span>
+#include <cstddef>
+
+#include "fulltimepad.h"
+
+// incremental encrypt/decrypt of a message that arrives in pieces of any size. The output is the same as
+// a single transform over the whole message, the unused end of a keystream block is kept for the next update
+template<FullTimePad::Version version=FullTimePad::Version10>
+class FullTimePadStream
+{
+	private:
+			FullTimePad &fulltimepad;
+
+			// encryption index of the next keystream block to generate
+			uint64_t encryption_index;
+
+			// current keystream block, bytes [offset, keysize) are unused
+			uint8_t keystream[FullTimePad::keysize];
+			uint8_t offset = FullTimePad::keysize;
+
+	public:
+			// fulltimepad: keyed cipher, has to outlive the stream
+			// encryption_index: encryption index of the first 32-byte segment of the message
+			FullTimePadStream(FullTimePad &fulltimepad, uint64_t encryption_index);
+
+			FullTimePadStream(const FullTimePadStream &) = delete;
+			FullTimePadStream &operator=(const FullTimePadStream &) = delete;
+
+			// encrypt/decrypt the next length bytes of the message
+			// in: plaintext data
+			// out: ciphertext data, either in itself (in-place) or a buffer that doesn't overlap in
+			void update(const uint8_t *in, uint8_t *out, size_t length);
+
+			// encrypt/decrypt the next in.size() bytes of the message, out has the same size as in
+			void update(std::span<const std::byte> in, std::span<std::byte> out);
+
+			// encrypt/decrypt the next data.size() bytes of the message in-place
+			void update(std::span<std::byte> data);
+
+			// end of message, wipes the keystream. returns the encryption index after the last segment used,
+			// where the next message can start without reusing keystream
+			uint64_t final();
+
+			// Destructor
+			~FullTimePadStream();
+};
+
+#endif /* FULLTIMEPAD_STREAM_H */
@@ -0,0 +1,300 @@
+/*
+ * @Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ */
+
+#ifndef INSTRUMENTATION_CPP
+#define INSTRUMENTATION_CPP
+
+#include "instrumentation.h"
+
+#ifdef FULLTIMEPAD_INSTRUMENT
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+// values of one version and phase in a registry entry: calls, blocks, bytes, sampled, then the hardware counters
+static constexpr int fields = 4 + Instrumentation::counters;
+
+// counters of one thread. Only the owning thread writes the values, so the adds are plain relaxed loads and stores.
+// Entries are never freed, the entry of an exited thread is reused by the next new thread
+struct RegistryEntry
+{
+	std::atomic<uint64_t> values[Instrumentation::versions][Instrumentation::phases][fields] = {};
+	std::atomic<bool> hardware[Instrumentation::counters] = {};
+
+	// label, written under the seqlock label_sequence (odd while written)
+	static constexpr size_t label_size = 64;
+	std::atomic<uint32_t> label_sequence{0};
+	std::atomic<char> label[label_size] = {};
+
+	std::atomic<bool> in_use{true};
+	RegistryEntry *next = nullptr; // set before the entry is published
+};
+
+// lock-free list of all entries, new entries are pushed at the head
+static std::atomic<RegistryEntry*> registry{nullptr};
+
+static std::atomic<uint32_t> sample_interval{64};
+
+static inline void add(std::atomic<uint64_t> &value, uint64_t x)
+{
+	value.store(value.load(std::memory_order_relaxed) + x, std::memory_order_relaxed);
+}
+
+static void write_label(RegistryEntry *entry, const std::string &label)
+{
+	const uint32_t sequence = entry->label_sequence.load(std::memory_order_relaxed);
+	entry->label_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for(size_t i=0;i<RegistryEntry::label_size;i++) {
+		entry->label[i].store(i < label.size() && i+1 < RegistryEntry::label_size ? label[i] : '\0', std::memory_order_relaxed);
+	}
+	entry->label_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+static std::string read_label(const RegistryEntry *entry)
+{
+	for(;;) {
+		const uint32_t sequence = entry->label_sequence.load(std::memory_order_acquire);
+		char label[RegistryEntry::label_size];
+		for(size_t i=0;i<RegistryEntry::label_size;i++) label[i] = entry->label[i].load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(sequence % 2 == 0 && entry->label_sequence.load(std::memory_order_relaxed) == sequence) return label;
+	}
+}
+
+// per-thread state: the registry entry and the perf_event_open group
+struct ThreadState
+{
+	RegistryEntry *entry;
+
+	// perf group: the first opened fd is the leader. slot[c] is the position of counter c in a group read, -1 if it couldn't be opened
+	int fd[Instrumentation::counters];
+	int slot[Instrumentation::counters];
+	int opened = 0; // counters in the group
+	bool tried = false;
+
+	// calls of each version and phase since the last sampled one
+	uint32_t since_sample[Instrumentation::versions][Instrumentation::phases] = {};
+
+	ThreadState();
+	~ThreadState();
+
+	void open_counters();
+	bool read_counters(uint64_t *values);
+};
+
+ThreadState::ThreadState()
+{
+	for(int c=0;c<Instrumentation::counters;c++) {
+		fd[c] = -1;
+		slot[c] = -1;
+	}
+
+	// reuse the entry of an exited thread, or push a new one
+	for(RegistryEntry *e=registry.load(std::memory_order_acquire);e;e=e->next) {
+		bool free = false;
+		if(!e->in_use.load(std::memory_order_relaxed) && e->in_use.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+			write_label(e, "");
+			entry = e;
+			return;
+		}
+	}
+	entry = new RegistryEntry();
+	entry->next = registry.load(std::memory_order_relaxed);
+	while(!registry.compare_exchange_weak(entry->next, entry, std::memory_order_release, std::memory_order_relaxed));
+}
+
+ThreadState::~ThreadState()
+{
+	for(int c=0;c<Instrumentation::counters;c++) {
+		if(fd[c] >= 0) close(fd[c]);
+	}
+	entry->in_use.store(false, std::memory_order_release);
+}
+
+// counters of the calling thread, user space only. Any of them can be missing (no PMU in a VM, perf_event_paranoid)
+void ThreadState::open_counters()
+{
+	tried = true;
+	#ifdef __linux__
+	static const uint32_t types[Instrumentation::counters] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+	static const uint64_t configs[Instrumentation::counters] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+
+	int leader = -1;
+	for(int c=0;c<Instrumentation::counters;c++) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = types[c];
+		attr.config = configs[c];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		const int f = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+		if(f < 0) continue;
+		if(leader < 0) leader = f;
+		fd[c] = f;
+		slot[c] = opened++;
+		entry->hardware[c].store(true, std::memory_order_relaxed);
+	}
+	#endif
+}
+
+// values[c]: current value of counter c. false if there are no counters
+bool ThreadState::read_counters(uint64_t *values)
+{
+	if(!tried) open_counters();
+	if(opened == 0) return false;
+
+	int leader = -1;
+	for(int c=0;c<Instrumentation::counters && leader<0;c++) leader = fd[c];
+
+	// PERF_FORMAT_GROUP: number of counters, then their values in the order they were opened
+	uint64_t group[1 + Instrumentation::counters];
+	if(read(leader, group, sizeof(uint64_t) * (1 + opened)) != ssize_t(sizeof(uint64_t) * (1 + opened)) || group[0] != uint64_t(opened)) return false;
+	for(int c=0;c<Instrumentation::counters;c++) {
+		values[c] = slot[c] >= 0 ? group[1 + slot[c]] : 0;
+	}
+	return true;
+}
+
+static thread_local ThreadState thread_state;
+
+void Instrumentation::set_sample_interval(uint32_t interval)
+{
+	sample_interval.store(interval, std::memory_order_relaxed);
+}
+
+void Instrumentation::set_thread_label(const std::string &label)
+{
+	write_label(thread_state.entry, label);
+}
+
+std::vector<Instrumentation::Snapshot> Instrumentation::snapshot()
+{
+	std::vector<Snapshot> snapshots;
+	for(RegistryEntry *e=registry.load(std::memory_order_acquire);e;e=e->next) {
+		Snapshot s;
+		s.label = read_label(e);
+		for(int v=0;v<versions;v++) {
+			for(int p=0;p<phases;p++) {
+				const std::atomic<uint64_t> *values = e->values[v][p];
+				Counters &c = s.phase[v][p];
+				c.calls = values[0].load(std::memory_order_relaxed);
+				c.blocks = values[1].load(std::memory_order_relaxed);
+				c.bytes = values[2].load(std::memory_order_relaxed);
+				c.sampled = values[3].load(std::memory_order_relaxed);
+				for(int h=0;h<counters;h++) c.hardware[h] = values[4+h].load(std::memory_order_relaxed);
+			}
+		}
+		for(int h=0;h<counters;h++) s.hardware[h] = e->hardware[h].load(std::memory_order_relaxed);
+		snapshots.push_back(s);
+	}
+	return snapshots;
+}
+
+void Instrumentation::count(int version, Phase phase, uint64_t calls, uint64_t blocks, uint64_t bytes)
+{
+	std::atomic<uint64_t> *values = thread_state.entry->values[version_index(version)][phase];
+	add(values[0], calls);
+	add(values[1], blocks);
+	add(values[2], bytes);
+}
+
+Instrumentation::Scope::Scope(int version, Phase phase, uint64_t blocks, uint64_t bytes) :
+	local(&thread_state), version(version_index(version)), phase(phase), sampled(false)
+{
+	ThreadState &state = *static_cast<ThreadState*>(local);
+	std::atomic<uint64_t> *values = state.entry->values[this->version][phase];
+	add(values[0], 1);
+	add(values[1], blocks);
+	add(values[2], bytes);
+
+	const uint32_t interval = sample_interval.load(std::memory_order_relaxed);
+	if(interval != 0 && ++state.since_sample[this->version][phase] >= interval) {
+		state.since_sample[this->version][phase] = 0;
+		sampled = state.read_counters(start);
+	}
+}
+
+Instrumentation::Scope::~Scope()
+{
+	if(!sampled) return;
+	ThreadState &state = *static_cast<ThreadState*>(local);
+	uint64_t end[counters];
+	if(!state.read_counters(end)) return;
+
+	std::atomic<uint64_t> *values = state.entry->values[version][phase];
+	add(values[3], 1);
+	for(int h=0;h<counters;h++) add(values[4+h], end[h] - start[h]);
+}
+
+#else
+
+// instrumentation is compiled out, there is nothing to count
+
+void Instrumentation::set_sample_interval(uint32_t)
+{
+}
+
+void Instrumentation::set_thread_label(const std::string &)
+{
+}
+
+void Instrumentation::count(int, Phase, uint64_t, uint64_t, uint64_t)
+{
+}
+
+std::vector<Instrumentation::Snapshot> Instrumentation::snapshot()
+{
+	return {};
+}
+
+#endif /* FULLTIMEPAD_INSTRUMENT */
+
+Instrumentation::Snapshot Instrumentation::total(const std::vector<Snapshot> &snapshots)
+{
+	Snapshot sum;
+	sum.label = "total";
+	for(const Snapshot &s : snapshots) {
+		for(int v=0;v<versions;v++) {
+			for(int p=0;p<phases;p++) {
+				Counters &c = sum.phase[v][p];
+				c.calls += s.phase[v][p].calls;
+				c.blocks += s.phase[v][p].blocks;
+				c.bytes += s.phase[v][p].bytes;
+				c.sampled += s.phase[v][p].sampled;
+				for(int h=0;h<counters;h++) c.hardware[h] += s.phase[v][p].hardware[h];
+			}
+		}
+		for(int h=0;h<counters;h++) sum.hardware[h] |= s.hardware[h];
+	}
+	return sum;
+}
+
+#endif /* INSTRUMENTATION_CPP */
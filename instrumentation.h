@@ -0,0 +1,132 @@
+/*
+ * @Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Hot-path counters of the cipher. Built with -DFULLTIMEPAD_INSTRUMENT (`make INSTRUMENT=1`) only, otherwise
+// FULLTIMEPAD_PROBE is empty and nothing is counted.
+// Each thread counts into its own registry entry, so a probe never writes shared cache lines or takes a lock.
+// Calls, blocks and bytes are counted on every probe. Every sample_interval-th call of a phase is also measured
+// with perf_event_open counters (cycles, instructions, L1D read misses, branch misses) when the kernel allows it.
+// Phases nest (a transform contains its transformations), so each phase's counters include its inner phases
+class Instrumentation
+{
+	public:
+			// instrumented parts of the cipher
+			enum Phase {
+				Transformation, // keystream of one block, or of all the SIMD blocks of a transform or hash_many call
+				Permutation, // dynamic permutations of the key words, counted per transformation and not timed
+				Endian, // key bytes to big endian words
+				Xor, // keystream XOR of transform
+				phases
+			};
+
+			// hardware counters
+			enum Counter {
+				Cycles,
+				Instructions,
+				L1DMisses,
+				BranchMisses,
+				counters
+			};
+
+			// Version 1.0, 1.1, 2.0, and version 0 for code shared by all versions (loading the key in the constructor)
+			static constexpr int versions = 4;
+			static constexpr int version_index(int version) {
+				return version == 10 ? 0 : version == 11 ? 1 : version == 20 ? 2 : 3;
+			}
+
+			// counted by one thread for one version and phase
+			struct Counters {
+				uint64_t calls = 0;
+				uint64_t blocks = 0; // 32-byte keystream blocks
+				uint64_t bytes = 0;
+				uint64_t sampled = 0; // calls measured with the hardware counters
+				uint64_t hardware[counters] = {}; // sum over the sampled calls, scale by calls/sampled for an estimate
+			};
+
+			// counters of a thread, or the total of all threads
+			struct Snapshot {
+				std::string label; // set_thread_label of the thread, e.g. the service it encrypts for
+				Counters phase[versions][phases];
+				bool hardware[counters] = {}; // which hardware counters could be opened
+			};
+
+			static constexpr bool enabled =
+			#ifdef FULLTIMEPAD_INSTRUMENT
+				true;
+			#else
+				false;
+			#endif
+
+			// every interval-th call of a phase is measured with the hardware counters, 0 turns them off. Default 64
+			static void set_sample_interval(uint32_t interval);
+
+			// label of the calling thread's counters in snapshots
+			static void set_thread_label(const std::string &label);
+
+			// counters of every thread that ever used the cipher. The entry of an exited thread keeps its counts
+			// until a new thread takes it over
+			static std::vector<Snapshot> snapshot();
+
+			// sum of snapshots, labelled "total"
+			static Snapshot total(const std::vector<Snapshot> &snapshots);
+
+			// adds calls, blocks and bytes to the calling thread's counters without timing them, for work inside a hot loop
+			// where a Scope would cost more than the work
+			static void count(int version, Phase phase, uint64_t calls, uint64_t blocks, uint64_t bytes);
+
+			// times a probe on the calling thread, from construction to destruction
+			class Scope
+			{
+				private:
+						void *local;
+						int version, phase;
+						bool sampled;
+						uint64_t start[counters];
+
+				public:
+						Scope(int version, Phase phase, uint64_t blocks, uint64_t bytes);
+						~Scope();
+
+						Scope(const Scope &) = delete;
+						Scope &operator=(const Scope &) = delete;
+			};
+};
+
+#ifdef FULLTIMEPAD_INSTRUMENT
+#define FULLTIMEPAD_PROBE_CONCAT(a, b) a##b
+#define FULLTIMEPAD_PROBE_NAME(line) FULLTIMEPAD_PROBE_CONCAT(instrumentation_probe_, line)
+// counts the rest of the enclosing block as phase of version (10, 11, 20 or 0)
+#define FULLTIMEPAD_PROBE(version, phase, blocks, bytes) \
+	Instrumentation::Scope FULLTIMEPAD_PROBE_NAME(__LINE__)(version, Instrumentation::phase, blocks, bytes)
+// counts calls of phase of version without timing them
+#define FULLTIMEPAD_COUNT(version, phase, calls, blocks, bytes) Instrumentation::count(version, Instrumentation::phase, calls, blocks, bytes)
+#else
+#define FULLTIMEPAD_PROBE(version, phase, blocks, bytes) ((void)0)
+#define FULLTIMEPAD_COUNT(version, phase, calls, blocks, bytes) ((void)0)
+#endif
+
+#endif /* INSTRUMENTATION_H */
@@ -1,13 +1,229 @@
 #include <stdint.h>
 #include <fstream>
 #include <bitset>
+#include <random>
+#include <algorithm>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "fulltimepad.h"
+#include "uring_transform.h"
 
-// This is an example file
-// TODO: make the optimization from Version 2.0 for  version 1.0, version 1.1 as well.
+// This is an example file, and a file encryption tool:
+//   fulltimepad encrypt|decrypt <key file> <input> [output] [-v 10|11|20] [-i encryption_index] [-t threads] [-u] [-d]
+// The file is encrypted in-place if there's no output. The key file holds the 32-byte key.
+// -u reads and writes through io_uring instead of mmap, -d also uses O_DIRECT
 
-int main()
+// trailer at the end of an encrypted file: magic, version, encryption index of the first byte.
+// A trailer rather than a header so a file can be encrypted/decrypted in-place without moving the data
+struct FileTrailer {
+	char magic[4] = {'F', 'T', 'P', '1'};
+	uint8_t version;
+	uint8_t reserved[3] = {0, 0, 0};
+	uint8_t encryption_index[8]; // little endian, so a file decrypts on a host of any byte order
+};
+static_assert(sizeof(FileTrailer) == 16);
+
+static void store_le64(uint8_t *out, uint64_t x)
+{
+	for(uint8_t i=0;i<8;i++) out[i] = x >> (i<<3);
+}
+
+static uint64_t load_le64(const uint8_t *in)
+{
+	uint64_t x = 0;
+	for(uint8_t i=0;i<8;i++) x |= uint64_t(in[i]) << (i<<3);
+	return x;
+}
+
+// a whole unsigned number, decimal or 0x hex, into x. returns false if arg is anything else or doesn't fit
+static bool parse_uint64(const char *arg, uint64_t &x)
+{
+	if(!isdigit(static_cast<unsigned char>(arg[0]))) return false; // strtoull would take a sign or spaces
+	char *end;
+	errno = 0;
+	x = strtoull(arg, &end, 0);
+	return *end == '\0' && errno == 0;
+}
+
+// bytes transformed before their write back is started, large enough for all threads of the pool
+static const size_t file_chunk = 64 << 20;
+
+// map a file, empty files aren't mapped
+static uint8_t *map_file(int fd, size_t length, int protection)
+{
+	if(length == 0) return nullptr;
+	void *data = mmap(nullptr, length, protection, MAP_SHARED, fd, 0);
+	if(data == MAP_FAILED) return nullptr;
+	madvise(data, length, MADV_SEQUENTIAL);
+	#ifdef MADV_HUGEPAGE
+	madvise(data, length, MADV_HUGEPAGE); // ignored where file-backed huge pages aren't supported
+	#endif
+	return static_cast<uint8_t*>(data);
+}
+
+// transform length bytes of in to out on all threads of pool, starting write back of every file_chunk bytes
+template<FullTimePad::Version version>
+static void transform_file(FullTimePad &fulltimepad, const uint8_t *in, uint8_t *out, size_t length, uint64_t encryption_index, ThreadPool &pool)
+{
+	for(size_t offset=0;offset<length;offset+=file_chunk) {
+		const size_t chunk_length = std::min(file_chunk, length - offset);
+		fulltimepad.parallel_transform<version>(in + offset, out + offset, chunk_length, encryption_index + offset/FullTimePad::keysize, pool);
+		msync(out + offset, chunk_length, MS_ASYNC);
+	}
+}
+
+#ifdef FULLTIMEPAD_URING
+// transform length bytes of in_fd to out_fd through io_uring, then write the trailer of an encrypted file and
+// truncate out_fd to out_length. returns 0, or -errno
+static int transform_file_uring(FullTimePad &fulltimepad, int in_fd, int out_fd, size_t length, size_t out_length, bool encrypt,
+                                const FileTrailer &trailer, ThreadPool &pool, bool direct)
+{
+	// O_DIRECT only for the pipeline, the trailer isn't aligned
+	if(direct && (fcntl(in_fd, F_SETFL, fcntl(in_fd, F_GETFL) | O_DIRECT) != 0 || fcntl(out_fd, F_SETFL, fcntl(out_fd, F_GETFL) | O_DIRECT) != 0)) {
+		return -errno;
+	}
+	const uint64_t encryption_index = load_le64(trailer.encryption_index);
+	int err;
+	switch(trailer.version) {
+		case FullTimePad::Version10:
+			err = uring_transform<FullTimePad::Version10>(fulltimepad, in_fd, out_fd, length, encryption_index, pool, direct);
+			break;
+		case FullTimePad::Version11:
+			err = uring_transform<FullTimePad::Version11>(fulltimepad, in_fd, out_fd, length, encryption_index, pool, direct);
+			break;
+		default:
+			err = uring_transform<FullTimePad::Version20>(fulltimepad, in_fd, out_fd, length, encryption_index, pool, direct);
+			break;
+	}
+	if(direct) {
+		fcntl(in_fd, F_SETFL, fcntl(in_fd, F_GETFL) & ~O_DIRECT);
+		fcntl(out_fd, F_SETFL, fcntl(out_fd, F_GETFL) & ~O_DIRECT);
+	}
+	if(err != 0) return err;
+
+	// the O_DIRECT padding, or the trailer of a decrypted in-place file is cut off
+	if(encrypt && pwrite(out_fd, &trailer, sizeof(FileTrailer), length) != sizeof(FileTrailer)) return -errno;
+	if(ftruncate(out_fd, out_length) != 0) return -errno;
+	if(fsync(out_fd) != 0) return -errno;
+	return 0;
+}
+#endif
+
+// encrypt/decrypt input into output, or in-place if output is nullptr
+// uring: io_uring instead of mmap, direct: with O_DIRECT
+// returns exit code
+static int transform_file(bool encrypt, uint8_t *key, const char *input, const char *output, uint8_t version, uint64_t encryption_index, unsigned int threads,
+                          [[maybe_unused]] bool uring, [[maybe_unused]] bool direct)
+{
+	const int in_fd = open(input, output ? O_RDONLY : O_RDWR);
+	struct stat st;
+	if(in_fd < 0 || fstat(in_fd, &st) != 0) {
+		std::cerr << input << ": " << strerror(errno) << std::endl;
+		return 1;
+	}
+	const size_t in_length = st.st_size;
+
+	// length of the data, and the trailer of an encrypted file
+	FileTrailer trailer;
+	size_t length = in_length;
+	if(encrypt) {
+		trailer.version = version;
+		store_le64(trailer.encryption_index, encryption_index);
+	}
+	else {
+		if(in_length < sizeof(FileTrailer) || pread(in_fd, &trailer, sizeof(FileTrailer), in_length - sizeof(FileTrailer)) != sizeof(FileTrailer)
+		   || memcmp(trailer.magic, FileTrailer().magic, sizeof(trailer.magic)) != 0) {
+			std::cerr << input << ": not a fulltimepad file" << std::endl;
+			close(in_fd);
+			return 1;
+		}
+		length = in_length - sizeof(FileTrailer);
+	}
+	if(trailer.version != FullTimePad::Version10 && trailer.version != FullTimePad::Version11 && trailer.version != FullTimePad::Version20) {
+		std::cerr << "unknown version " << trailer.version+0 << std::endl;
+		close(in_fd);
+		return 1;
+	}
+	const size_t out_length = encrypt ? length + sizeof(FileTrailer) : length;
+
+	// in-place: the file is resized to the output, mapped once and written through the same mapping
+	int out_fd = in_fd;
+	if(output) {
+		out_fd = open(output, O_RDWR | O_CREAT | O_TRUNC, 0600);
+	}
+	if(out_fd < 0 || ((encrypt || output) && ftruncate(out_fd, out_length) != 0)) {
+		std::cerr << (output ? output : input) << ": " << strerror(errno) << std::endl;
+		close(in_fd);
+		if(output && out_fd >= 0) close(out_fd);
+		return 1;
+	}
+
+	#ifdef FULLTIMEPAD_URING
+	if(uring) {
+		ThreadPool pool(threads);
+		FullTimePad fulltimepad = FullTimePad(key);
+		const int err = transform_file_uring(fulltimepad, in_fd, out_fd, length, out_length, encrypt, trailer, pool, direct);
+		close(in_fd);
+		if(output) close(out_fd);
+		if(err != 0) {
+			std::cerr << "io_uring: " << strerror(-err) << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+	#endif
+
+	const size_t out_map_length = output ? out_length : std::max(in_length, out_length);
+	uint8_t *out = map_file(out_fd, out_map_length, PROT_READ | PROT_WRITE);
+	const uint8_t *in = output ? map_file(in_fd, in_length, PROT_READ) : out;
+	if((out == nullptr && out_length != 0) || (in == nullptr && in_length != 0)) {
+		std::cerr << "mmap: " << strerror(errno) << std::endl;
+		close(in_fd);
+		if(output) close(out_fd);
+		return 1;
+	}
+
+	ThreadPool pool(threads);
+	FullTimePad fulltimepad = FullTimePad(key);
+	const uint64_t start_index = load_le64(trailer.encryption_index);
+	switch(trailer.version) {
+		case FullTimePad::Version10:
+			transform_file<FullTimePad::Version10>(fulltimepad, in, out, length, start_index, pool);
+			break;
+		case FullTimePad::Version11:
+			transform_file<FullTimePad::Version11>(fulltimepad, in, out, length, start_index, pool);
+			break;
+		default:
+			transform_file<FullTimePad::Version20>(fulltimepad, in, out, length, start_index, pool);
+			break;
+	}
+	if(encrypt) {
+		memcpy(out + length, &trailer, sizeof(FileTrailer));
+	}
+
+	// success only once the file is on the disk, MS_ASYNC only started the write back
+	int err = 0;
+	if(out && msync(out, out_map_length, MS_SYNC) != 0) err = errno;
+	if(out) munmap(out, out_map_length);
+	if(output && in) munmap(const_cast<uint8_t*>(in), in_length);
+	if(err == 0 && !encrypt && !output && ftruncate(in_fd, length) != 0) err = errno; // drop the trailer
+	if(err == 0 && fsync(out_fd) != 0) err = errno;
+	close(in_fd);
+	if(output) close(out_fd);
+	if(err != 0) {
+		std::cerr << (output ? output : input) << ": " << strerror(err) << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// example of encrypting and decrypting 32 bytes
+static int demo()
 {
 	uint8_t pt[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
 	uint8_t ct[32];
@@ -70,3 +286,54 @@ int main()
 	
 	return 0;
 }
+
+int main(int argc, char *argv[])
+{
+	if(argc == 1) return demo();
+
+	const bool encrypt = argc > 1 && strcmp(argv[1], "encrypt") == 0;
+	if(argc < 4 || (!encrypt && strcmp(argv[1], "decrypt") != 0)) {
+		std::cerr << "usage: " << argv[0] << " encrypt|decrypt <key file> <input> [output] [-v 10|11|20] [-i encryption_index] [-t threads] [-u] [-d]" << std::endl;
+		return 1;
+	}
+
+	// a random encryption index by default, so files encrypted with the same key don't share keystream
+	const char *output = nullptr;
+	uint8_t version = FullTimePad::Version20;
+	uint64_t encryption_index = (uint64_t(std::random_device()()) << 32) | std::random_device()();
+	unsigned int threads = std::thread::hardware_concurrency();
+	bool uring = false, direct = false;
+	for(int i=4;i<argc;i++) {
+		if(strcmp(argv[i], "-v") == 0 && i+1 < argc) version = strtoul(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-i") == 0 && i+1 < argc) {
+			if(!parse_uint64(argv[++i], encryption_index)) {
+				std::cerr << "invalid encryption index " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if(strcmp(argv[i], "-t") == 0 && i+1 < argc) threads = strtoul(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-u") == 0) uring = true;
+		else if(strcmp(argv[i], "-d") == 0) uring = direct = true;
+		else if(output == nullptr && argv[i][0] != '-') output = argv[i];
+		else {
+			std::cerr << "unknown argument " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+
+	uint8_t key[FullTimePad::keysize];
+	std::ifstream key_file(argv[2], std::ios::binary);
+	if(!key_file.read(reinterpret_cast<char*>(key), FullTimePad::keysize)) {
+		std::cerr << argv[2] << ": needs a " << FullTimePad::keysize << "-byte key" << std::endl;
+		return 1;
+	}
+	#ifndef FULLTIMEPAD_URING
+	if(uring) {
+		std::cerr << "io_uring isn't supported on this system" << std::endl;
+		return 1;
+	}
+	#endif
+	const int ret = transform_file(encrypt, key, argv[3], output, version, encryption_index, threads, uring, direct);
+	explicit_bzero(key, FullTimePad::keysize);
+	return ret;
+}
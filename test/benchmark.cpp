@@ -1,9 +1,21 @@
-#include <iomanip>
 #include <iostream>
 #include <chrono>
 #include <random>
+#include <vector>
+#include <span>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 #include "../fulltimepad.h"
+#include "../thread_pool.h"
 
 // generate a random 32-byte key
 void gen_rand_key(uint8_t *key)
@@ -14,130 +26,225 @@ void gen_rand_key(uint8_t *key)
 	for(uint8_t i=0;i<32;i++) key[i] = dist(gen);
 }
 
-// Check for a potential Side Channel Vulnerability to check if small numbers are faster
-template<FullTimePad::Version version>
-void benchmark_hash_time_attack_v()
+// benchmark settings, from the command line
+struct Options
 {
-	uint8_t *key = new uint8_t[32];
-    uint8_t transformed_key[32];
-	double speeds[256]; // keep an array of all speeds. Compare after it's done
-	constexpr int reps = (version == FullTimePad::Version20) ? 10000 : 1000;
-
-	for(int i=0;i<256;i++) {
-		// assign key to 32 0s to 32 255s
-		for(int j=0;j<32;j++) {
-			key[j] = i;
-		}
-		FullTimePad fulltimepad = FullTimePad(key);
-    	auto start = std::chrono::high_resolution_clock::now(); // start timing
+	std::string format = "text"; // text, csv or json
+	size_t max_size = size_t(1) << 30; // largest message, 1 GiB
+	size_t hash_max_size = size_t(1) << 24; // largest message for the one-hash-per-block path, it is far slower
+	unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+	double min_time = 0.2; // seconds measured per result
+};
+
+// one line of output
+struct Result
+{
+	const char *benchmark; // size or threads
+	const char *version;
+	const char *path; // transform, hash or parallel
+	const char *cache; // warm or cold
+	unsigned int threads;
+	size_t bytes; // message size
+	uint64_t reps;
+	double seconds; // time of all reps
+	uint64_t cycles; // TSC cycles of all reps, 0 without a TSC
+};
+
+// the SIMD kernels compiled into the library. Every path uses them, the scalar numbers come from a `make ARCH=` build
+static const char *simd_kernels()
+{
+	#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VBMI__)
+	return "avx512";
+	#elif defined(__AVX2__)
+	return "avx2";
+	#elif defined(__SSSE3__)
+	return "ssse3";
+	#else
+	return "scalar";
+	#endif
+}
 
-		// get the average of 1000 repetations to get more consistent numbers
-		for(int j=0;j<reps;j++) {
-			fulltimepad.hash<version>(transformed_key, 0); // key is different each time so encryption index can be the same
-		}
-    	auto end = std::chrono::high_resolution_clock::now(); // end timing
-    	std::chrono::duration<double> timer = end - start; // how long calculation took
-		speeds[i] = timer.count()/reps;
-	}
+// time stamp counter. Constant rate on current x86, so these are reference cycles, not core cycles under turbo
+static inline uint64_t cycles_now()
+{
+	#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+	#else
+	return 0;
+	#endif
+}
 
-	// analyize speed data (check if they are consistent)
-	bool consistent = true;
-	for(int i=1;i<256;i++) {
-		if(round(speeds[i]/speeds[i-1]) != 1) {
-			consistent = false;
-			std::cout << "FAILED at: " << std::setprecision(5) << speeds[i] << " " << speeds[i-1];
-		}
+static inline double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// evict data from all cache levels before a cold run
+static void flush(const uint8_t *data, size_t length)
+{
+	#ifdef __SSE2__
+	for(size_t i=0;i<length;i+=64) _mm_clflush(data + i);
+	_mm_mfence();
+	#else
+	// without clflush, overwrite a buffer larger than the last level cache
+	static std::vector<uint8_t> eviction(size_t(64) << 20);
+	for(size_t i=0;i<eviction.size();i+=64) eviction[i]++;
+	(void)data; (void)length;
+	#endif
+}
+
+// run `run` until min_time seconds are measured.
+// warm: reps are timed in doubling batches, so the clock isn't part of small messages.
+// cold: every rep is timed on its own after data is flushed out of the caches
+template<typename Run>
+static Result measure(Result result, Run run, const uint8_t *data, bool cold, const Options &options)
+{
+	run(); // first touch of the pages, and data in cache for the warm runs
+	result.cache = cold ? "cold" : "warm";
+	result.reps = 0;
+	result.seconds = 0;
+	result.cycles = 0;
+
+	const auto wall = std::chrono::steady_clock::now();
+	for(uint64_t batch=1;result.seconds < options.min_time && seconds_since(wall) < 10*options.min_time;) {
+		if(cold) flush(data, result.bytes);
+		const auto start = std::chrono::steady_clock::now();
+		const uint64_t start_cycles = cycles_now();
+		for(uint64_t i=0;i<batch;i++) run();
+		result.cycles += cycles_now() - start_cycles;
+		result.seconds += seconds_since(start);
+		result.reps += batch;
+		if(!cold) batch *= 2;
 	}
+	return result;
+}
+
+// throughput of transform and of one hash call per block, for message sizes 1 B, 4 B, ... up to max_size
+template<FullTimePad::Version version>
+void benchmark_sizes(const char *name, const Options &options, std::vector<Result> &results)
+{
+	uint8_t key[FullTimePad::keysize];
+	gen_rand_key(key);
+	FullTimePad fulltimepad = FullTimePad(key);
+
+	std::vector<uint8_t> data(options.max_size);
+	for(size_t i=0;i<data.size();i++) data[i] = i;
 
-	if(consistent) {
-	
-		// check for first and last speed.
-		if(round(speeds[0]/speeds[255]) != 1)
-			consistent = false;
-
-		if(consistent) { // if still consistent
-			// However, test if speed were consistently growing: It shouldn't
-			double counter=0;
-			for(int i=1;i<256;i++) {
-				if(speeds[i] > speeds[i-1]) { // if current speed is bigger than previous speed, computation time is increasing as numbers get bigger
-					counter++;
-				}
+	for(size_t bytes=1;bytes<=options.max_size;bytes*=4) {
+		const std::span<std::byte> message = std::as_writable_bytes(std::span(data.data(), bytes));
+		auto transform = [&]() { fulltimepad.transform<version>(message, 0); };
+
+		// one block at a time through hash, what a caller of the per-block API gets. Not a scalar baseline,
+		// hash permutes the key with the same shuffles as transform, it only misses the multi-block kernels
+		auto hash = [&]() {
+			uint8_t transformed_key[FullTimePad::keysize];
+			for(size_t i=0;i<bytes;i+=FullTimePad::keysize) {
+				fulltimepad.hash<version>(transformed_key, i/FullTimePad::keysize);
+				for(size_t j=0;j<FullTimePad::keysize && i+j<bytes;j++) data[i+j] ^= transformed_key[j];
 			}
-			if(round(256/counter) == 2) { // final check, half the time, the speeds should be bigger then previous and vice versa.
-				std::cout << "PASSED (NO SIDE CHANNEL): data is consistent " << " \n";
-			} else {
-				std::cout << "FAILED (POTENTIAL SIDE-CHANNEL): data is increasing consistently " << " \n";
-				for(int i=0;i<256;i++) {
-					std::cout << std::setprecision(5) << speeds[i] << "\t";
-				}
+		};
+
+		const Result result = {"size", name, "transform", "", 1, bytes, 0, 0, 0};
+		for(bool cold : {false, true}) {
+			results.push_back(measure(result, transform, data.data(), cold, options));
+			if(bytes <= options.hash_max_size) {
+				Result hash_result = result;
+				hash_result.path = "hash";
+				results.push_back(measure(hash_result, hash, data.data(), cold, options));
 			}
-		} else {
-			std::cout << "FAILED (POTENTIAL SIDE-CHANNEL): first and last data isn\'t consistent\nRATIO (speed[0]/speed[255]):\n";
-			std::cout << speeds[0]/speeds[255] << "\t";
-		}
-	} else {
-		std::cout << "FAILED (POTENTIAL SIDE-CHANNEL): data isn\'t consistent\nDATA:\n";
-		for(int i=1;i<256;i++) {
-			// if this ratio is close to 1, then numbers are about the same and therefore consistent numbers.
-			std::cout << speeds[i]/speeds[i-1] << "\t";
 		}
+		std::cerr << "." << std::flush;
 	}
-	std::cout << std::endl;
-
-	delete[] key;
 }
 
-
+// parallel_transform of one large message on 1, 2, 4, ... max_threads threads
 template<FullTimePad::Version version>
-void benchmark_hash()
+void benchmark_threads(const char *name, const Options &options, std::vector<Result> &results)
 {
-	uint8_t *key = new uint8_t[32];
-    uint8_t transformed_key[32];
+	uint8_t key[FullTimePad::keysize];
 	gen_rand_key(key);
-
 	FullTimePad fulltimepad = FullTimePad(key);
 
-    // Start the clock to measure encryption time
-	// call hash function 1,000,000 times
-    auto start = std::chrono::high_resolution_clock::now();
-    for (size_t i = 0; i < 1000000; ++i) {
-		fulltimepad.hash<version>(transformed_key, i); // i is encryption index;
-
-    }
+	const size_t bytes = std::min(options.max_size, size_t(1) << 28);
+	std::vector<uint8_t> data(bytes);
+	for(size_t i=0;i<data.size();i++) data[i] = i;
+	const std::span<std::byte> message = std::as_writable_bytes(std::span(data));
+
+	for(unsigned int threads=1;;threads=std::min(threads*2, options.max_threads)) {
+		ThreadPool pool(threads);
+		auto parallel = [&]() { fulltimepad.parallel_transform<version>(message, 0, pool); };
+		results.push_back(measure(Result{"threads", name, "parallel", "", threads, bytes, 0, 0, 0}, parallel, data.data(), false, options));
+		std::cerr << "." << std::flush;
+		if(threads == options.max_threads) break;
+	}
+}
 
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> timer = end - start;
-    double speed = 1000000 / timer.count();
+static void print_text(const std::vector<Result> &results)
+{
+	printf("simd kernels: %s\n", simd_kernels());
+	printf("%-8s %-8s %-10s %-5s %7s %12s %10s %10s %12s\n", "bench", "version", "path", "cache", "threads", "bytes", "reps", "GB/s", "cycles/byte");
+	for(const Result &r : results) {
+		const double bytes = double(r.bytes) * r.reps;
+		printf("%-8s %-8s %-10s %-5s %7u %12zu %10lu %10.3f %12.3f\n", r.benchmark, r.version, r.path, r.cache, r.threads, r.bytes,
+				(unsigned long)r.reps, bytes/r.seconds/1e9, r.cycles/bytes);
+	}
+}
 
-    std::cout << "Computation Time for " << 1000000 << " key transformations: "
-              << timer.count() << " seconds" << std::endl;
-    std::cout << "Hashrate: " << (uint64_t)speed << " keys per second" << std::endl;
+static void print_csv(const std::vector<Result> &results)
+{
+	printf("benchmark,version,simd,path,cache,threads,bytes,reps,seconds,cycles,gb_per_s,cycles_per_byte\n");
+	for(const Result &r : results) {
+		const double bytes = double(r.bytes) * r.reps;
+		printf("%s,%s,%s,%s,%s,%u,%zu,%lu,%.9g,%lu,%.6g,%.6g\n", r.benchmark, r.version, simd_kernels(), r.path, r.cache, r.threads, r.bytes,
+				(unsigned long)r.reps, r.seconds, (unsigned long)r.cycles, bytes/r.seconds/1e9, r.cycles/bytes);
+	}
+}
 
-	delete[] key;
+static void print_json(const std::vector<Result> &results)
+{
+	printf("{\n\t\"simd\": \"%s\",\n\t\"hardware_threads\": %u,\n\t\"results\": [", simd_kernels(), std::thread::hardware_concurrency());
+	for(size_t i=0;i<results.size();i++) {
+		const Result &r = results[i];
+		const double bytes = double(r.bytes) * r.reps;
+		printf("%s\n\t\t{\"benchmark\": \"%s\", \"version\": \"%s\", \"path\": \"%s\", \"cache\": \"%s\", \"threads\": %u, \"bytes\": %zu, "
+				"\"reps\": %lu, \"seconds\": %.9g, \"cycles\": %lu, \"gb_per_s\": %.6g, \"cycles_per_byte\": %.6g}", i ? "," : "",
+				r.benchmark, r.version, r.path, r.cache, r.threads, r.bytes, (unsigned long)r.reps, r.seconds, (unsigned long)r.cycles,
+				bytes/r.seconds/1e9, r.cycles/bytes);
+	}
+	printf("\n\t]\n}\n");
 }
 
-int main()
+int main(int argc, char *argv[])
 {
-	// test speed of hashing algorithm:
-	std::cout << "\n\n----------TESTING SPEED----------";
-	std::cout << "\nTESTING TRANSFORMATION VERSION 1.0: ";
-	benchmark_hash<FullTimePad::Version10>();
-	std::cout << "\nTESTING TRANSFORMATION VERSION 1.1: ";
-	benchmark_hash<FullTimePad::Version11>();
-	std::cout << "\nTESTING TRANSFORMATION VERSION 2.0: ";
-	benchmark_hash<FullTimePad::Version20>();
-
-	/*
-	 * Upon further testing, The permutation can be made more efficient by using a uniform permutation matrix rather than a non-uniform permutation matrix. In Other words, instead of placeholder vector, use swapping.
-	 * */
-
-	// test for time-based side channel attack possibility:
-	std::cout << "\n\n----------TESTING SIDE CHANNEL ATTACKS----------";
-	std::cout << "\nTESTING TRANSFORMATION VERSION 1.0: ";
-	benchmark_hash_time_attack_v<FullTimePad::Version10>(); // PASSED
-	std::cout << "\nTESTING TRANSFORMATION VERSION 1.1: ";
-	benchmark_hash_time_attack_v<FullTimePad::Version11>(); // PASSED
-	std::cout << "\nTESTING TRANSFORMATION VERSION 2.0: ";
-	benchmark_hash_time_attack_v<FullTimePad::Version20>(); // PASSED
+	Options options;
+	for(int i=1;i<argc;i++) {
+		if(strcmp(argv[i], "-f") == 0 && i+1 < argc) options.format = argv[++i];
+		else if(strcmp(argv[i], "-s") == 0 && i+1 < argc) options.max_size = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-t") == 0 && i+1 < argc) options.max_threads = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+		else if(strcmp(argv[i], "-m") == 0 && i+1 < argc) options.min_time = strtod(argv[++i], nullptr);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-f text|csv|json] [-s max bytes] [-t max threads] [-m seconds per result]" << std::endl;
+			return 1;
+		}
+	}
+	if(options.format != "text" && options.format != "csv" && options.format != "json") {
+		std::cerr << "unknown format " << options.format << std::endl;
+		return 1;
+	}
+	options.max_size = std::max<size_t>(options.max_size, 1);
+
+	// progress goes to stderr, so stdout stays machine readable
+	std::vector<Result> results;
+	benchmark_sizes<FullTimePad::Version10>("1.0", options, results);
+	benchmark_sizes<FullTimePad::Version11>("1.1", options, results);
+	benchmark_sizes<FullTimePad::Version20>("2.0", options, results);
+	benchmark_threads<FullTimePad::Version10>("1.0", options, results);
+	benchmark_threads<FullTimePad::Version11>("1.1", options, results);
+	benchmark_threads<FullTimePad::Version20>("2.0", options, results);
+	std::cerr << std::endl;
+
+	if(options.format == "csv") print_csv(results);
+	else if(options.format == "json") print_json(results);
+	else print_text(results);
 	return 0;
 }
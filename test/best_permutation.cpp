@@ -31,9 +31,27 @@
 #include <random>
 #include <array>
 #include <bit>
-
-// print best permutation matrix after signal interrupt
-static bool doprint = false;
+#include <fstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <cmath>
+#include <tuple>
+
+#include "../fulltimepad.h"
+#include "../thread_pool.h"
+
+// the kernel templates of the cipher, so -benchmark can compile candidate schedules into them
+#include "../fulltimepad_kernels.h"
+
+// candidate schedules for -benchmark, from the archive of the optimizer: `make CANDIDATES=permutation_archive.h`
+#ifdef PERMUTATION_CANDIDATES
+#include PERMUTATION_CANDIDATES
+#endif
 
 // how the collision calculation should be performed
 enum CollisionCalculation {
@@ -41,239 +59,64 @@ enum CollisionCalculation {
 	random_key
 };
 
-// check endiannes before assigning n_V to big/little endian version
-static consteval bool is_big_endian() {
-	return std::endian::native == std::endian::big;
-}
-
-// 256-bit Full-Time-Pad Cipher
-class FullTimePadTest
-{
-	public:
-
-			// ideal permutations: would have 1 byte shifted to each another 32-bit number.
-			// e.g. byte 0 goes to byte 4
-			static constexpr std::array<std::array<uint8_t, 32>, 16> n_V_big_endian = {{
-				{0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29, 2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31},
-				{4, 8, 12, 0, 20, 24, 28, 16, 5, 9, 13, 1, 21, 25, 29, 17, 6, 10, 14, 2, 22, 26, 30, 18, 7, 11, 15, 3, 23, 27, 31, 19},
-				{8, 12, 0, 4, 24, 28, 16, 20, 9, 13, 1, 5, 25, 29, 17, 21, 10, 14, 2, 6, 26, 30, 18, 22, 11, 15, 3, 7, 27, 31, 19, 23},
-				{12, 0, 4, 8, 28, 16, 20, 24, 13, 1, 5, 9, 29, 17, 21, 25, 14, 2, 6, 10, 30, 18, 22, 26, 15, 3, 7, 11, 31, 19, 23, 27},
-				{12, 28, 13, 29, 14, 30, 15, 31, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23, 8, 24, 9, 25, 10, 26, 11, 27},
-				{28, 13, 29, 12, 30, 15, 31, 14, 16, 1, 17, 0, 18, 3, 19, 2, 20, 5, 21, 4, 22, 7, 23, 6, 24, 9, 25, 8, 26, 11, 27, 10},
-				{13, 29, 12, 28, 15, 31, 14, 30, 1, 17, 0, 16, 3, 19, 2, 18, 5, 21, 4, 20, 7, 23, 6, 22, 9, 25, 8, 24, 11, 27, 10, 26},
-				{29, 12, 28, 13, 31, 14, 30, 15, 17, 0, 16, 1, 19, 2, 18, 3, 21, 4, 20, 5, 23, 6, 22, 7, 25, 8, 24, 9, 27, 10, 26, 11},
-				{29, 31, 17, 19, 21, 23, 25, 27, 12, 14, 0, 2, 4, 6, 8, 10, 28, 30, 16, 18, 20, 22, 24, 26, 13, 15, 1, 3, 5, 7, 9, 11},
-				{31, 17, 19, 29, 23, 25, 27, 21, 14, 0, 2, 12, 6, 8, 10, 4, 30, 16, 18, 28, 22, 24, 26, 20, 15, 1, 3, 13, 7, 9, 11, 5},
-				{17, 19, 29, 31, 25, 27, 21, 23, 0, 2, 12, 14, 8, 10, 4, 6, 16, 18, 28, 30, 24, 26, 20, 22, 1, 3, 13, 15, 9, 11, 5, 7},
-				{19, 29, 31, 17, 27, 21, 23, 25, 2, 12, 14, 0, 10, 4, 6, 8, 18, 28, 30, 16, 26, 20, 22, 24, 3, 13, 15, 1, 11, 5, 7, 9},
-				{19, 27, 2, 10, 18, 26, 3, 11, 29, 21, 12, 4, 28, 20, 13, 5, 31, 23, 14, 6, 30, 22, 15, 7, 17, 25, 0, 8, 16, 24, 1, 9},
-				{27, 2, 10, 19, 26, 3, 11, 18, 21, 12, 4, 29, 20, 13, 5, 28, 23, 14, 6, 31, 22, 15, 7, 30, 25, 0, 8, 17, 24, 1, 9, 16},
-				{2, 10, 19, 27, 3, 11, 18, 26, 12, 4, 29, 21, 13, 5, 28, 20, 14, 6, 31, 23, 15, 7, 30, 22, 0, 8, 17, 25, 1, 9, 16, 24},
-				{10, 19, 27, 2, 11, 18, 26, 3, 4, 29, 21, 12, 5, 28, 20, 13, 6, 31, 23, 14, 7, 30, 22, 15, 8, 17, 25, 0, 9, 16, 24, 1}
-			}};
-
-			// LITTLE ENDIAN:
-			static constexpr std::array<std::array<uint8_t, 32>, 16> n_V_little_endian = {{
-				{15, 11, 7, 3, 31, 27, 23, 19, 14, 10, 6, 2, 30, 26, 22, 18, 13, 9, 5, 1, 29, 25, 21, 17, 12, 8, 4, 0, 28, 24, 20, 16},
-				{3, 15, 11, 7, 19, 31, 27, 23, 2, 14, 10, 6, 18, 30, 26, 22, 1, 13, 9, 5, 17, 29, 25, 21, 0, 12, 8, 4, 16, 28, 24, 20},
-				{7, 3, 15, 11, 23, 19, 31, 27, 6, 2, 14, 10, 22, 18, 30, 26, 5, 1, 13, 9, 21, 17, 29, 25, 4, 0, 12, 8, 20, 16, 28, 24},
-				{11, 7, 3, 15, 27, 23, 19, 31, 10, 6, 2, 14, 26, 22, 18, 30, 9, 5, 1, 13, 25, 21, 17, 29, 8, 4, 0, 12, 24, 20, 16, 28},
-				{30, 14, 31, 15, 28, 12, 29, 13, 18, 2, 19, 3, 16, 0, 17, 1, 22, 6, 23, 7, 20, 4, 21, 5, 26, 10, 27, 11, 24, 8, 25, 9},
-				{15, 30, 14, 31, 13, 28, 12, 29, 3, 18, 2, 19, 1, 16, 0, 17, 7, 22, 6, 23, 5, 20, 4, 21, 11, 26, 10, 27, 9, 24, 8, 25},
-				{31, 15, 30, 14, 29, 13, 28, 12, 19, 3, 18, 2, 17, 1, 16, 0, 23, 7, 22, 6, 21, 5, 20, 4, 27, 11, 26, 10, 25, 9, 24, 8},
-				{14, 31, 15, 30, 12, 29, 13, 28, 2, 19, 3, 18, 0, 17, 1, 16, 6, 23, 7, 22, 4, 21, 5, 20, 10, 27, 11, 26, 8, 25, 9, 24},
-				{16, 18, 28, 30, 24, 26, 20, 22, 1, 3, 13, 15, 9, 11, 5, 7, 17, 19, 29, 31, 25, 27, 21, 23, 0, 2, 12, 14, 8, 10, 4, 6},
-				{30, 16, 18, 28, 22, 24, 26, 20, 15, 1, 3, 13, 7, 9, 11, 5, 31, 17, 19, 29, 23, 25, 27, 21, 14, 0, 2, 12, 6, 8, 10, 4},
-				{28, 30, 16, 18, 20, 22, 24, 26, 13, 15, 1, 3, 5, 7, 9, 11, 29, 31, 17, 19, 21, 23, 25, 27, 12, 14, 0, 2, 4, 6, 8, 10},
-				{18, 28, 30, 16, 26, 20, 22, 24, 3, 13, 15, 1, 11, 5, 7, 9, 19, 29, 31, 17, 27, 21, 23, 25, 2, 12, 14, 0, 10, 4, 6, 8},
-				{9, 1, 24, 16, 8, 0, 25, 17, 7, 15, 22, 30, 6, 14, 23, 31, 5, 13, 20, 28, 4, 12, 21, 29, 11, 3, 26, 18, 10, 2, 27, 19},
-				{16, 9, 1, 24, 17, 8, 0, 25, 30, 7, 15, 22, 31, 6, 14, 23, 28, 5, 13, 20, 29, 4, 12, 21, 18, 11, 3, 26, 19, 10, 2, 27},
-				{24, 16, 9, 1, 25, 17, 8, 0, 22, 30, 7, 15, 23, 31, 6, 14, 20, 28, 5, 13, 21, 29, 4, 12, 26, 18, 11, 3, 27, 19, 10, 2},
-				{1, 24, 16, 9, 0, 25, 17, 8, 15, 22, 30, 7, 14, 23, 31, 6, 13, 20, 28, 5, 12, 21, 29, 4, 3, 26, 18, 11, 2, 27, 19, 10},
-			}};
-
-			static consteval std::array<std::array<uint8_t, 32>, 16> get_n_V() {
-				return is_big_endian() ? n_V_big_endian : n_V_little_endian;
-			}
-	private:
-
-			// constant array used in the transformation of the key
-			uint32_t A[8] = {
-				0x184f03e9, 
-				0x216c46df,
-				0x119f904f,
-				0x64997dfd,
-				0x2a5497bd,
-				0x3918fa83,
-				0xaf820335,
-				0x85096c2e,
-			};
-			
-			// for modular addition in a Prime Galois Field, field size p, largest 32-bit unsigned prime number
-			static const constexpr uint32_t fp = 4294967291; // 0xfffffffb
-		
-			// rotation index r
-			static const constexpr uint8_t r[] = {
-				23, 5, 17, 31, 13
-			};
-		
-			// bitwise right rotation
-			inline uint32_t rotr(uint32_t x, uint8_t shift)
-			{
-				return (x >> shift) | (x << ((sizeof(x)<<3)-shift));
-			}
-		
-			// bitwise left rotation
-			inline uint32_t rotl(uint32_t x, uint8_t shift)
-			{
-				return (x << shift) | (x >> ((sizeof(x)<<3)-shift));
-			}
-		
-			// initial key, before any permutation
-			uint8_t *init_key;
-		
-			// dynamically permutate the key during iteration
-			// key: permutated 32-byte key
-			// p: dynamically re-purmutated key
-			// ni: index of dynamic permutation number n
-			// ni: iteration index
-			void dynamic_permutation(uint8_t *key, uint8_t *p, uint8_t ni, uint8_t **best_n_V)
-			{
-				for(uint8_t i=0;i<keysize;i++) {
-					p[i] = key[best_n_V[ni][i]];
-				}
-				memcpy(key, p, keysize); // copy the repurmutated values
-			}
-
-			// convert uint8_t *key into uint32_t *k in big endian
-			static uint32_t *endian_8_to_32_arr(uint8_t *key)
-			{
-				if constexpr(!is_big_endian()) {
-				    for (uint8_t i=0;i<FullTimePadTest::keysize;i+=4) {
-			       		std::swap(key[i], key[i+3]);
-			       		std::swap(key[i+1], key[i+2]);
-			    	}
-				}
-					return reinterpret_cast<uint32_t*>(key);
-			}
-		
-			// iterations for the main transformation loop
-			void transformation(uint8_t *key, uint8_t **best_n_V) // length of k is 8
-			{
-				// vector used for dynamic permutation, dynamically permutated key placeholder
-				// use stack memory but for really large nubmer of encryptions performed at once, it might be too much for stack, but that is very unlikely.
-				uint8_t p[keysize];
-		
-				// 32-bit array ints for key for arithmetic ARX manipulations
-				uint32_t *k = endian_8_to_32_arr(key);
-				for(uint8_t i=0;i<16;i++) {
-					uint8_t index = i<<2;
-					uint8_t i1mod = index % 8;
-					uint8_t i2mod = (index+1) % 8;
-					uint8_t i3mod = (index+2) % 8;
-					uint8_t i4mod = (index+3) % 8;
-					uint8_t imod8 = i % 8;
-					uint8_t imod9 = (i+1) % 8;
-	
-					uint8_t rmod = i % 5; // 5 rotation values
-					k[i1mod] = ( ( ((uint64_t)k[i1mod] + A[imod8]) % fp) + rotr(k[i1mod], r[rmod])  ) % fp;
-	
-					uint32_t sum = ((uint64_t)k[0] + k[1] + k[2] + k[3] + k[4] + k[5] + k[6] + k[7]) % fp;
-
-					A[imod9] ^= sum;
-	
-					k[i2mod] = ( ( ((uint64_t)k[i2mod] + A[imod9]) % fp) + rotl(k[i2mod], r[rmod])  ) % fp; // uint64_t to make sure there is no unwanted overflow
-					
-					A[imod8] ^= ((uint64_t)k[i2mod] + rotr(k[i1mod], r[(i+1)%5])) % fp;
-	
-					k[i3mod] =( (uint64_t)(A[imod8] ^ k[i3mod]) + (A[imod9] ^ k[i4mod]) ) % fp;
-					k[i4mod] =( (uint64_t)(A[imod8] ^ k[i4mod]) + (A[imod9] ^ k[i3mod]) ) % fp;
-		
-					// permutate the bytearray key
-					dynamic_permutation(key, p, i, best_n_V);
-				}
-		
-			}
-
-	public:
-			const constexpr static uint8_t keysize = 32;
-
-			// key: 256-bit (32-byte) key, should be allocated with length keysize
-			void hash(uint8_t *key, uint8_t **best_n_V)
-			{
-				// transformation iterations
-				transformation(key, best_n_V);
-
-			}
-};
+// permutation schedule: 16 permutations of the 32 key bytes in the byte order of FullTimePad::n_V_big_endian,
+// row ni moves byte n_V[ni][i] of the key to byte i
+typedef std::array<std::array<uint8_t, 32>, 16> ScheduleTable;
 
+// hash of key with the schedule n_V, through the rounds of the cipher. The schedules of a search are only known at run time,
+// so the permutations are done with shifts instead of compiled shuffles
+static std::array<uint8_t, 32> schedule_hash(FullTimePad::Version version, const std::array<uint8_t, 32> &key, const ScheduleTable &n_V)
+{
+	if(version == FullTimePad::Version20) return FullTimePad::hash<FullTimePad::Version20>(key, 0, n_V);
+	if(version == FullTimePad::Version11) return FullTimePad::hash<FullTimePad::Version11>(key, 0, n_V);
+	return FullTimePad::hash<FullTimePad::Version10>(key, 0, n_V);
+}
 
-// generate a random 32-byte key
-void gen_rand_key(uint8_t *key)
+// generate a random 32-byte key from seed
+void gen_rand_key(uint8_t *key, uint64_t seed)
 {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<uint8_t> dist(0, 0xff);
-	for(uint8_t i=0;i<32;i++) key[i] = dist(gen);
+	std::mt19937_64 gen(seed);
+	for(uint8_t i=0;i<32;i++) key[i] = gen();
 }
 
-// calculate the collision rate with random key
-double find_collision_rate_random_key(uint8_t **best_n_V)
+// calculate the collision rate of version with the random key random_key, changed in its first byte
+double find_collision_rate_random_key(const ScheduleTable &best_n_V, FullTimePad::Version version, const uint8_t *random_key)
 {
 	double collision_rate = 0;
-	uint8_t tmp[32];
-	uint8_t initial_key[32];
-	uint8_t oldkey[32];
-	gen_rand_key(tmp); // initialize a random initial key
-	memcpy(oldkey, tmp, 32);
+	std::array<uint8_t, 32> initial_key;
+	std::array<uint8_t, 32> oldkey;
 	for(int k=1;k<256;k++) { // calculate average collision rate
-		memcpy(initial_key, tmp, 32);
-		memcpy(oldkey, tmp, 32);
-		FullTimePadTest fulltimepad1 = FullTimePadTest();
-		FullTimePadTest fulltimepad2 = FullTimePadTest();
+		memcpy(initial_key.data(), random_key, 32);
+		memcpy(oldkey.data(), random_key, 32);
 		initial_key[0] = k;
 		oldkey[0] = k-1;
 
-		fulltimepad1.hash(initial_key, best_n_V);
-		fulltimepad2.hash(oldkey, best_n_V);
-		double temp_col = 0;
+		const std::array<uint8_t, 32> hash1 = schedule_hash(version, initial_key, best_n_V);
+		const std::array<uint8_t, 32> hash2 = schedule_hash(version, oldkey, best_n_V);
 		for(int i=0;i<32;i++) {
-			if(initial_key[i] == oldkey[i]) {
-				temp_col++;
+			if(hash1[i] == hash2[i]) {
+				collision_rate++;
 			}
 		}
-		
-		// print the percentage changes when one bit of data is changed in key
-		double col = temp_col/32*100;
-		collision_rate += temp_col;
-		if(col < 10)
-			std::cout << std::dec << std::fixed << std::setprecision(4) << '0' << col << "%\t";
-		else 
-			std::cout << std::dec << std::fixed << std::setprecision(4) << col << "%\t";
-		if(k%10 == 0) std::cout << std::endl;
 	}
 	collision_rate/=32*255;
-	//for(int i=0;i<32;i++) std::cout << std::hex << std::setfill('0') << std::setw(2) << initial_key[i]+0 << ", ";
-	//std::cout << std::endl;
 	return collision_rate*100;
 }
 
-// calculate the collision rate with incrementing integers key
-double find_collision_rate(uint8_t **best_n_V)
+// calculate the collision rate of version with incrementing integers key
+double find_collision_rate(const ScheduleTable &best_n_V, FullTimePad::Version version)
 {
 	double collision_rate = 0;
 	for(int k=1;k<2;k++) {
-		uint8_t initial_key[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
-		uint8_t oldkey[]      = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
-		FullTimePadTest fulltimepad1 = FullTimePadTest();
-		FullTimePadTest fulltimepad2 = FullTimePadTest();
+		std::array<uint8_t, 32> initial_key = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
+		std::array<uint8_t, 32> oldkey      = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
 		initial_key[0] = k;
 		oldkey[0] = k-1;
 
-		fulltimepad1.hash(initial_key, best_n_V);
-		fulltimepad2.hash(oldkey, best_n_V);
+		const std::array<uint8_t, 32> hash1 = schedule_hash(version, initial_key, best_n_V);
+		const std::array<uint8_t, 32> hash2 = schedule_hash(version, oldkey, best_n_V);
 		for(int i=0;i<32;i++) {
-			if(initial_key[i] == oldkey[i]) {
+			if(hash1[i] == hash2[i]) {
 				collision_rate++;
 			}
 		}
@@ -284,125 +127,739 @@ double find_collision_rate(uint8_t **best_n_V)
 	return collision_rate*100;
 }
 
+// rows of n_V that are reordered, the last 4 rows stay in place
+static constexpr uint8_t rows = 12;
 
+// number of orderings of the rows, 12!
+static constexpr uint64_t factorial(uint8_t n)
+{
+	return n <= 1 ? 1 : n * factorial(n-1);
+}
+static constexpr uint64_t orderings = factorial(rows);
 
-// permutate the matrix n_V by swapping indexes with new ones
-void permutate_matrix(uint8_t **n_V, uint8_t **placeholder, std::vector<uint8_t> index)
+// ordering of lexicographic rank rank, from its Lehmer code: digit i (base rows-i) picks the row among the ones not used yet.
+// The same order as std::next_permutation from {0, 1, ..., 11}
+std::array<uint8_t, rows> unrank(uint64_t rank)
 {
-	// permutate matrix
-	for(uint8_t i=0;i<12;i++) {
-		for(uint8_t j=0;j<32;j++) {
-			placeholder[i][j] = n_V[index[i]][j];
-		}
+	std::array<uint8_t, rows> left, index;
+	for(uint8_t i=0;i<rows;i++) left[i] = i;
+	for(uint8_t i=0;i<rows;i++) {
+		const uint64_t f = factorial(rows-1-i);
+		const uint8_t digit = rank / f;
+		rank %= f;
+		index[i] = left[digit];
+		memmove(&left[digit], &left[digit+1], rows-1-digit);
 	}
-
-	// copy the values back from the placeholder
-	for(uint8_t i=0;i<12;i++)
-		memcpy(n_V[i], placeholder[i], 32);
+	return index;
 }
 
 // print the best n_V matrix
-void print_best_n_V(uint8_t **n_V)
+void print_best_n_V(const ScheduleTable &n_V)
 {
 	std::cout << "\nbest n_V: {";
-	for(int i=0;i<12;i++) {
+	for(int i=0;i<rows;i++) {
 		std::cout << "\n\t{" << std::dec;
 		for(int j=0;j<32;j++) {
 			std::cout << n_V[i][j]+0;
 			if(j != 31) std::cout << ", ";
 		}
 		std::cout << "}";
-		if (i != 11) std::cout << ",";
+		if (i != rows-1) std::cout << ",";
 	}
 	std::cout << "\n}";
 }
 
-// find the best n_V
-void new_n_V(uint8_t **n_V, uint8_t **placeholder, double &best_collision_rate, uint32_t &permutations_count, CollisionCalculation collision_calc)
-{
-    std::vector<uint8_t> index = {0,1,2,3,4,5,6,7,8,9,10,11}; // index of n_V
-
-    do {
-		// find collision rate
-		double collision_rate;
-		if(collision_calc == incrementing_key)
-			collision_rate = find_collision_rate(n_V);
-		else
-			collision_rate = find_collision_rate_random_key(n_V);
-
-
-		// permutate the matrix
-		permutate_matrix(n_V, placeholder, index);
-
-        // Update the best permutation if a lower collision rate is found
-        if (collision_rate < best_collision_rate) {
-            best_collision_rate = collision_rate;
-			std::cout << "new best collision rate: " << best_collision_rate << "%";
-			print_best_n_V(n_V);
-			std::cout << "\npermutations_count: " << permutations_count << "\n";
-        }
-
-		// if exited program
-		if (doprint) {
-			std::cout << "\n\nbest collision rate: " << best_collision_rate << "%";
-			print_best_n_V(n_V);
-			std::cout << "\npermutations_count: " << permutations_count << "\n";
-
-			// safely deallocate before exit
-			for(uint8_t i=0;i<12;i++) {
-				delete[] n_V[i];
-				delete[] placeholder[i];
+// stop the search, write a checkpoint and the best permutation, then exit
+static std::atomic<bool> stop{false};
+
+// ranks a thread takes at once
+static constexpr uint64_t chunk = 1024;
+
+// search settings, from the command line
+struct Options
+{
+	CollisionCalculation collision_calc = incrementing_key;
+	FullTimePad::Version version = FullTimePad::Version10;
+	uint64_t seed = 0; // random key of random_key
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	uint64_t process = 0, processes = 1; // this process searches the ranks [process*12!/processes, (process+1)*12!/processes)
+	std::string checkpoint = "best_permutation.checkpoint";
+	unsigned int interval = 60; // seconds between checkpoints
+	bool resume = false;
+};
+
+// state shared by the threads of a search. Chunks are taken in increasing order, so everything below the lowest
+// chunk in progress is done
+struct Search
+{
+	Options options;
+	uint64_t begin = 0, end = 0; // ranks of this process
+	std::atomic<uint64_t> next{0}; // first rank not taken yet
+	std::unique_ptr<std::atomic<uint64_t>[]> current; // first rank of the chunk of each thread, UINT64_MAX when idle
+	uint8_t random_key[32];
+
+	// lowest collision rate, and its rank. Ties keep the lower rank, so the result doesn't depend on the threads
+	std::mutex best_lock;
+	double best_collision_rate = UINT32_MAX;
+	uint64_t best_rank = UINT64_MAX;
+};
+
+// ranks below this are done
+static uint64_t done(Search &search)
+{
+	uint64_t low = std::min(search.next.load(), search.end);
+	for(unsigned int t=0;t<search.options.threads;t++) low = std::min(low, search.current[t].load());
+	return low;
+}
+
+// the rows of the shipped n_V in the order index
+static void order_rows(ScheduleTable &n_V, const std::array<uint8_t, rows> &index)
+{
+	for(uint8_t i=0;i<rows;i++) n_V[i] = FullTimePad::DefaultSchedule::n_V_big_endian[index[i]];
+}
+
+// merge a thread's best into the search, report it if it's the new best
+static void merge_best(Search &search, double collision_rate, uint64_t rank)
+{
+	std::lock_guard<std::mutex> guard(search.best_lock);
+	if(collision_rate > search.best_collision_rate || (collision_rate == search.best_collision_rate && rank >= search.best_rank)) return;
+	search.best_collision_rate = collision_rate;
+	search.best_rank = rank;
+
+	const std::array<uint8_t, rows> index = unrank(rank);
+	std::cout << "\nnew best collision rate: " << collision_rate << "%\trank: " << rank << "\torder: {";
+	for(uint8_t i=0;i<rows;i++) std::cout << index[i]+0 << (i != rows-1 ? ", " : "}");
+	std::cout << std::flush;
+}
+
+// take chunks of ranks until the search is done, keep the thread's best and merge it after each chunk
+void search_thread(Search &search, unsigned int t)
+{
+	// the shipped n_V with its first rows in the order of the rank
+	ScheduleTable n_V = FullTimePad::DefaultSchedule::n_V_big_endian;
+
+	double best_collision_rate = UINT32_MAX;
+	uint64_t best_rank = UINT64_MAX;
+	while(!stop.load(std::memory_order_relaxed)) {
+		// publish the chunk before taking it, so done() never skips it
+		search.current[t] = search.next.load();
+		const uint64_t begin = search.next.fetch_add(chunk);
+		search.current[t] = begin;
+		if(begin >= search.end) break;
+		const uint64_t end = std::min(begin + chunk, search.end);
+
+		for(uint64_t rank=begin;rank<end;rank++) {
+			// unranked again instead of std::next_permutation, which GCC's -Wstringop-overflow can't bound on the 12 rows.
+			// A few hundred operations next to the hashes of a collision rate
+			order_rows(n_V, unrank(rank));
+			const double collision_rate = search.options.collision_calc == incrementing_key ? find_collision_rate(n_V, search.options.version)
+			                                                                                 : find_collision_rate_random_key(n_V, search.options.version, search.random_key);
+			if(collision_rate < best_collision_rate) {
+				best_collision_rate = collision_rate;
+				best_rank = rank;
+			}
+		}
+		merge_best(search, best_collision_rate, best_rank);
+		search.current[t] = UINT64_MAX;
+	}
+	search.current[t] = UINT64_MAX;
+}
+
+// write the progress and the best rank. Written to a temporary file and renamed, so an interrupted write leaves the previous checkpoint
+bool write_checkpoint(Search &search)
+{
+	const std::string tmp = search.options.checkpoint + ".tmp";
+	std::ofstream file(tmp);
+	const uint64_t next = done(search);
+	{
+		std::lock_guard<std::mutex> guard(search.best_lock);
+		file << std::setprecision(17) << "version " << int(search.options.version) << "\nrandom " << (search.options.collision_calc == random_key) << "\nseed " << search.options.seed
+		     << "\nbegin " << search.begin << "\nend " << search.end << "\nnext " << next
+		     << "\nbest " << search.best_collision_rate << "\nrank " << search.best_rank << "\n";
+	}
+	file.close();
+	return file && rename(tmp.c_str(), search.options.checkpoint.c_str()) == 0;
+}
+
+bool read_checkpoint(const std::string &path, Options &options, uint64_t &begin, uint64_t &end, uint64_t &next, double &best, uint64_t &rank)
+{
+	std::ifstream file(path);
+	std::string field;
+	bool random = false;
+	int version = 0;
+	file >> field >> version >> field >> random >> field >> options.seed >> field >> begin >> field >> end >> field >> next >> field >> best >> field >> rank;
+	options.collision_calc = random ? random_key : incrementing_key;
+	options.version = FullTimePad::Version(version);
+	return bool(file) && (version == 10 || version == 11 || version == 20) && begin <= next && end <= orderings;
+}
+
+// print the best permutation table
+static void print_best(Search &search)
+{
+	std::lock_guard<std::mutex> guard(search.best_lock);
+	if(search.best_rank == UINT64_MAX) return;
+	ScheduleTable n_V = FullTimePad::DefaultSchedule::n_V_big_endian;
+	order_rows(n_V, unrank(search.best_rank));
+	std::cout << "\n\nbest collision rate: " << search.best_collision_rate << "%\trank: " << search.best_rank;
+	print_best_n_V(n_V);
+}
+
+// find the best n_V: the ranks of this process with all threads, until every one is done or SIGINT.
+// Checkpoints every interval seconds and at the end
+int new_n_V(Options options)
+{
+	Search search;
+	search.options = options;
+	search.current = std::make_unique<std::atomic<uint64_t>[]>(options.threads);
+	for(unsigned int t=0;t<options.threads;t++) search.current[t] = UINT64_MAX;
+
+	if(options.resume) {
+		uint64_t next;
+		if(!read_checkpoint(options.checkpoint, search.options, search.begin, search.end, next, search.best_collision_rate, search.best_rank)) {
+			std::cerr << "\ncan't resume from " << options.checkpoint << std::endl;
+			return 1;
+		}
+		search.next = next;
+	}
+	else {
+		search.begin = orderings / options.processes * options.process;
+		search.end = options.process+1 == options.processes ? orderings : orderings / options.processes * (options.process+1);
+		search.next = search.begin;
+	}
+	gen_rand_key(search.random_key, search.options.seed);
+
+	std::cout << "RUNNING " << (search.options.collision_calc == random_key ? "RANDOM KEY" : "INCREMENTING KEY") << " - TRANSFORMATION ALGORTIHM "
+	          << search.options.version/10 << "." << search.options.version%10 << " - RANKS " << search.begin << " TO " << search.end
+	          << " OF " << orderings << " - " << options.threads << " THREADS" << std::flush;
+
+	std::vector<std::thread> threads;
+	for(unsigned int t=0;t<options.threads;t++) threads.emplace_back(search_thread, std::ref(search), t);
+
+	// the threads finish on their own once every rank is taken
+	std::atomic<unsigned int> running{options.threads};
+	std::thread waiter([&]() {
+		for(std::thread &thread : threads) thread.join();
+		running = 0;
+	});
+
+	auto last = std::chrono::steady_clock::now();
+	uint64_t last_done = done(search);
+	while(running != 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		const auto now = std::chrono::steady_clock::now();
+		if(now - last >= std::chrono::seconds(options.interval)) {
+			const uint64_t n = done(search);
+			std::cout << "\npermutations_count: " << n - search.begin << " of " << search.end - search.begin << "\t"
+			          << uint64_t((n - last_done) / std::chrono::duration<double>(now - last).count()) << " permutations/s";
+			if(!write_checkpoint(search)) std::cout << "\tcan't write " << options.checkpoint;
+			std::cout << std::flush;
+			last = now;
+			last_done = n;
+		}
+	}
+	waiter.join();
+
+	write_checkpoint(search);
+	print_best(search);
+	std::cout << "\npermutations_count: " << done(search) - search.begin << "\n";
+	if(done(search) == search.end) std::cout << std::endl << "PROGRAM FINSIHED, ALL PERMUTATIONS TRIED" << std::endl;
+	return 0;
+}
+
+// best permutation of the checkpoints of several processes
+int merge(const std::vector<std::string> &paths)
+{
+	Search search;
+	uint64_t count = 0, total = 0;
+	for(const std::string &path : paths) {
+		uint64_t begin, end, next, rank;
+		double best;
+		Options options;
+		if(!read_checkpoint(path, options, begin, end, next, best, rank)) {
+			std::cerr << "can't read " << path << std::endl;
+			return 1;
+		}
+		// the collision rates are only comparable with the same calculation and key
+		if(path != paths[0] && (options.version != search.options.version || options.collision_calc != search.options.collision_calc
+		                        || (options.collision_calc == random_key && options.seed != search.options.seed))) {
+			std::cerr << path << " is a search with another version, collision calculation or seed" << std::endl;
+			return 1;
+		}
+		search.options = options;
+		count += next - begin;
+		total += end - begin;
+		if(best < search.best_collision_rate || (best == search.best_collision_rate && rank < search.best_rank)) {
+			search.best_collision_rate = best;
+			search.best_rank = rank;
+		}
+	}
+	print_best(search);
+	std::cout << "\npermutations_count: " << count << " of " << total << std::endl;
+	return 0;
+}
+
+// metaheuristic search settings, from the command line
+struct OptimizerOptions
+{
+	FullTimePad::Version version = FullTimePad::Version10;
+	uint64_t seed = 0; // random keys of the fitness, and the random choices of the search
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	uint64_t anneal = 0; // annealing steps
+	uint64_t generations = 0; // genetic algorithm generations
+	size_t population = 64;
+	double weight = 0; // score per shuffle instruction, on top of the collision and avalanche
+	std::string archive = "permutation_archive.h";
+};
+
+// fitness of a schedule. The archive keeps the schedules no other schedule beats in all four of
+// collision_rate, avalanche, shuffles and cross_lane
+struct Fitness
+{
+	double collision_rate; // % equal bytes, find_collision_rate_random_key
+	double avalanche; // mean distance of the flipped output bits from 50% after a single-bit key change, in %
+	uint32_t shuffles; // pshufb of a round in the AVX2 8-key kernel: one per source word of each output word
+	uint32_t cross_lane; // rows that move bytes between 128-bit lanes: more than a single pshufb without vpermb
+	double score; // collision_rate + avalanche + weight*(shuffles + 3*cross_lane), minimized by the optimizers
+};
+
+// keys changed in single bits for the avalanche
+static constexpr uint8_t avalanche_keys = 8;
+
+// the cost of the shuffles the production kernels compile a schedule to. Words and lanes are the same in either byte order
+static void shuffle_cost(const ScheduleTable &schedule, Fitness &fitness)
+{
+	fitness.shuffles = 0;
+	fitness.cross_lane = 0;
+	for(const std::array<uint8_t, 32> &row : schedule) {
+		bool cross = false;
+		for(uint8_t w=0;w<8;w++) {
+			uint8_t sources = 0; // bit s: word w takes bytes from word s
+			for(uint8_t b=0;b<4;b++) {
+				sources |= 1 << (row[(w<<2) + b] >> 2);
+				cross |= (row[(w<<2) + b] >> 4) != (w >> 2);
+			}
+			fitness.shuffles += std::popcount(sources);
+		}
+		fitness.cross_lane += cross;
+	}
+}
+
+// fitness of schedule, on the random keys of seed. The same for every thread and run with the same seed
+Fitness evaluate(const ScheduleTable &schedule, const OptimizerOptions &options)
+{
+	Fitness fitness;
+	uint8_t random_key[32];
+	gen_rand_key(random_key, options.seed);
+	fitness.collision_rate = find_collision_rate_random_key(schedule, options.version, random_key);
+
+	// every key with one bit changed in each byte, a different bit of the byte for every byte
+	double avalanche = 0;
+	for(uint8_t k=0;k<avalanche_keys;k++) {
+		std::array<uint8_t, 32> key;
+		gen_rand_key(key.data(), options.seed + k + 1);
+		const std::array<uint8_t, 32> hashed = schedule_hash(options.version, key, schedule);
+		for(uint8_t i=0;i<32;i++) {
+			std::array<uint8_t, 32> flipped = key;
+			flipped[i] ^= 1 << ((i + k) & 7);
+			flipped = schedule_hash(options.version, flipped, schedule);
+			int distance = 0;
+			for(uint8_t j=0;j<32;j++) distance += std::popcount(uint8_t(hashed[j] ^ flipped[j]));
+			avalanche += fabs(distance / 256.0 - 0.5);
+		}
+	}
+	fitness.avalanche = avalanche / (avalanche_keys * 32) * 100;
+
+	shuffle_cost(schedule, fitness);
+	// a cross-lane row costs a lane swap, a second pshufb and an or in the single-block kernel
+	fitness.score = fitness.collision_rate + fitness.avalanche + options.weight * (fitness.shuffles + 3*fitness.cross_lane);
+	return fitness;
+}
+
+// fitness of every schedule of a batch, in parallel on the pool
+std::vector<Fitness> evaluate_batch(ThreadPool &pool, const std::vector<ScheduleTable> &batch, const OptimizerOptions &options)
+{
+	std::vector<Fitness> fitness(batch.size());
+	pool.parallel_for(batch.size(), [&](size_t i) {
+		fitness[i] = evaluate(batch[i], options);
+	});
+	return fitness;
+}
+
+// a dominates b: at least as good in every objective and better in one
+static bool dominates(const Fitness &a, const Fitness &b)
+{
+	const bool no_worse = a.collision_rate <= b.collision_rate && a.avalanche <= b.avalanche && a.shuffles <= b.shuffles && a.cross_lane <= b.cross_lane;
+	const bool better = a.collision_rate < b.collision_rate || a.avalanche < b.avalanche || a.shuffles < b.shuffles || a.cross_lane < b.cross_lane;
+	return no_worse && better;
+}
+
+// Pareto archive of diffusion and shuffle cost
+struct Archive
+{
+	std::vector<std::pair<ScheduleTable, Fitness>> front;
+
+	// keep schedule if no archived schedule dominates or equals it, and drop the ones it dominates
+	void offer(const ScheduleTable &schedule, const Fitness &fitness) {
+		for(const auto &entry : front) {
+			const Fitness &f = entry.second;
+			if(dominates(f, fitness) || (f.collision_rate == fitness.collision_rate && f.avalanche == fitness.avalanche && f.shuffles == fitness.shuffles && f.cross_lane == fitness.cross_lane)) return;
+		}
+		std::erase_if(front, [&](const std::pair<ScheduleTable, Fitness> &entry) { return dominates(fitness, entry.second); });
+		front.push_back({schedule, fitness});
+	}
+};
+
+// state of an optimizer run: the best schedule by score and the archive of everything evaluated
+struct Optimizer
+{
+	OptimizerOptions options;
+	ThreadPool pool;
+	std::mt19937_64 gen;
+	Archive archive;
+	ScheduleTable best;
+	Fitness best_fitness = {0, 0, 0, 0, UINT32_MAX};
+	uint64_t evaluated = 0;
+
+	explicit Optimizer(const OptimizerOptions &options) : options(options), pool(options.threads), gen(options.seed ^ 0x5851f42d4c957f2d) {}
+
+	std::vector<Fitness> evaluate(const std::vector<ScheduleTable> &batch) {
+		std::vector<Fitness> fitness = evaluate_batch(pool, batch, options);
+		for(size_t i=0;i<batch.size();i++) {
+			archive.offer(batch[i], fitness[i]);
+			if(fitness[i].score < best_fitness.score) {
+				best = batch[i];
+				best_fitness = fitness[i];
+			}
+		}
+		evaluated += batch.size();
+		return fitness;
+	}
+
+	// swap two bytes of a random row, keeps every row a permutation. One in four swaps moves two bytes that
+	// cross lanes back into their lanes, if there are any, so in-lane rows can be reached
+	void mutate(ScheduleTable &schedule) {
+		std::array<uint8_t, 32> &row = schedule[gen() & 15];
+		const uint8_t i = gen() & 31;
+		if(gen() & 3) {
+			std::swap(row[i], row[gen() & 31]);
+			return;
+		}
+		for(uint8_t j=0;j<32;j++) {
+			const uint8_t a = (i + j) & 31;
+			if((row[a] >> 4) == (a >> 4)) continue;
+			for(uint8_t k=0;k<32;k++) {
+				const uint8_t b = (a + k) & 31;
+				if((b >> 4) == (row[a] >> 4) && (row[b] >> 4) == (a >> 4)) {
+					std::swap(row[a], row[b]);
+					return;
+				}
 			}
-			delete[] n_V;
-			delete[] placeholder;
-			exit(0);
 		}
+	}
+};
 
-		permutations_count++;
-    } while (std::next_permutation(index.begin(), index.end()));
+static void print_fitness(const Fitness &f)
+{
+	std::cout << std::fixed << std::setprecision(4) << "collision: " << f.collision_rate << "%\tavalanche: " << f.avalanche
+	          << "%\tshuffles: " << f.shuffles << "\tcross-lane rows: " << f.cross_lane << "\tscore: " << f.score << std::defaultfloat;
 }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-parameter"
-void signal_handler(int sig) {
-	doprint = true;
+static void write_table(std::ostream &out, const ScheduleTable &schedule, const char *indent = "")
+{
+	out << "{{";
+	for(uint8_t ni=0;ni<16;ni++) {
+		out << "\n" << indent << "\t{";
+		for(uint8_t i=0;i<32;i++) out << schedule[ni][i]+0 << (i != 31 ? ", " : "}");
+		if(ni != 15) out << ",";
+	}
+	out << "\n" << indent << "}}";
+}
+
+// simulated annealing: each step evaluates a batch of neighbours in parallel and moves to the best one,
+// or to a worse one with probability exp(-difference/temperature). The temperature falls geometrically from 1 to 0.001
+void anneal(Optimizer &optimizer, const ScheduleTable &start)
+{
+	const size_t neighbours = optimizer.options.threads * 4;
+	ScheduleTable current = start;
+	double current_score = optimizer.evaluate({start})[0].score;
+	const double cooling = pow(0.001, 1.0 / std::max<uint64_t>(1, optimizer.options.anneal));
+	double temperature = 1;
+	std::uniform_real_distribution<double> uniform(0, 1);
+
+	for(uint64_t step=0;step<optimizer.options.anneal && !stop.load(std::memory_order_relaxed);step++, temperature*=cooling) {
+		std::vector<ScheduleTable> batch(neighbours, current);
+		for(ScheduleTable &s : batch) {
+			for(uint64_t m=1+(optimizer.gen()%3);m>0;m--) optimizer.mutate(s);
+		}
+		const std::vector<Fitness> fitness = optimizer.evaluate(batch);
+		const size_t next = std::min_element(fitness.begin(), fitness.end(), [](const Fitness &a, const Fitness &b) { return a.score < b.score; }) - fitness.begin();
+		if(fitness[next].score < current_score || uniform(optimizer.gen) < exp((current_score - fitness[next].score) / temperature)) {
+			current = batch[next];
+			current_score = fitness[next].score;
+		}
+		if(step % 100 == 0) {
+			std::cout << "\nstep " << step << "\ttemperature: " << temperature << "\tcurrent score: " << current_score << "\tbest: ";
+			print_fitness(optimizer.best_fitness);
+			std::cout << std::flush;
+		}
+	}
+}
+
+// genetic algorithm: tournament selection, rows taken from either parent with one row crossed over by order crossover,
+// swap mutations and the 2 best schedules kept as they are. Each generation is evaluated in parallel
+void genetic(Optimizer &optimizer, const ScheduleTable &start)
+{
+	std::mt19937_64 &gen = optimizer.gen;
+	const size_t size = std::max<size_t>(optimizer.options.population, 4);
+	std::vector<ScheduleTable> population(size, start);
+	for(size_t i=1;i<size;i++) {
+		for(int m=0;m<16;m++) optimizer.mutate(population[i]);
+	}
+	std::vector<Fitness> fitness = optimizer.evaluate(population);
+
+	auto tournament = [&]() -> const ScheduleTable& {
+		size_t winner = gen() % size;
+		for(int i=0;i<2;i++) {
+			const size_t other = gen() % size;
+			if(fitness[other].score < fitness[winner].score) winner = other;
+		}
+		return population[winner];
+	};
+
+	for(uint64_t generation=0;generation<optimizer.options.generations && !stop.load(std::memory_order_relaxed);generation++) {
+		std::vector<size_t> order(size);
+		for(size_t i=0;i<size;i++) order[i] = i;
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fitness[a].score < fitness[b].score; });
+
+		std::vector<ScheduleTable> children = {population[order[0]], population[order[1]]};
+		while(children.size() < size) {
+			const ScheduleTable &a = tournament(), &b = tournament();
+			ScheduleTable child;
+			for(uint8_t ni=0;ni<16;ni++) child[ni] = gen() & 1 ? a[ni] : b[ni];
+
+			// order crossover: a slice of a's row, the other bytes in the order of b's row
+			const uint8_t ni = gen() & 15, first = gen() & 31, last = first + gen() % (32 - first);
+			std::array<bool, 32> taken = {};
+			for(uint8_t i=first;i<=last;i++) {
+				child[ni][i] = a[ni][i];
+				taken[a[ni][i]] = true;
+			}
+			uint8_t j = 0;
+			for(uint8_t i=0;i<32;i++) {
+				if(i >= first && i <= last) continue;
+				while(taken[b[ni][j]]) j++;
+				child[ni][i] = b[ni][j++];
+			}
+
+			for(uint64_t m=gen()%3;m>0;m--) optimizer.mutate(child);
+			children.push_back(child);
+		}
+		population = children;
+		fitness = optimizer.evaluate(population);
+
+		std::cout << "\ngeneration " << generation << "\tbest: ";
+		print_fitness(optimizer.best_fitness);
+		std::cout << "\tarchive: " << optimizer.archive.front.size() << std::flush;
+	}
+}
+
+// optimize the shipped schedule with annealing and/or the genetic algorithm, then print the best schedule and
+// write the Pareto archive
+int optimize(const OptimizerOptions &options)
+{
+	Optimizer optimizer(options);
+	ScheduleTable start = FullTimePad::DefaultSchedule::n_V_big_endian;
+
+	std::cout << "shipped n_V: ";
+	print_fitness(evaluate(start, options));
+	std::cout << std::flush;
+
+	if(options.anneal) {
+		anneal(optimizer, start);
+		start = optimizer.best;
+	}
+	if(options.generations) genetic(optimizer, start);
+
+	std::cout << "\n\nbest of " << optimizer.evaluated << " schedules: ";
+	print_fitness(optimizer.best_fitness);
+	std::cout << "\nn_V_big_endian = ";
+	write_table(std::cout, optimizer.best);
+	std::cout << "\n";
+
+	// the archive from the cheapest to shuffle
+	std::sort(optimizer.archive.front.begin(), optimizer.archive.front.end(), [](const auto &a, const auto &b) {
+		return std::tie(a.second.shuffles, a.second.cross_lane, a.second.collision_rate, a.second.avalanche) < std::tie(b.second.shuffles, b.second.cross_lane, b.second.collision_rate, b.second.avalanche);
+	});
+	// written as schedule types for FullTimePad and a list of them for -benchmark
+	std::ofstream file(options.archive);
+	file << "// Pareto archive of ./best_permutation, version " << options.version/10 << "." << options.version%10 << ", seed " << options.seed << "\n";
+	std::cout << "\nPareto archive (" << optimizer.archive.front.size() << " schedules, written to " << options.archive << "):";
+	for(size_t i=0;i<optimizer.archive.front.size();i++) {
+		const auto &entry = optimizer.archive.front[i];
+		std::cout << "\n";
+		print_fitness(entry.second);
+		file << "\n// collision: " << entry.second.collision_rate << "% avalanche: " << entry.second.avalanche << "% shuffles: "
+		     << entry.second.shuffles << " cross-lane rows: " << entry.second.cross_lane << "\n"
+		     << "struct Candidate" << i << " {\n\tstatic constexpr std::array<std::array<uint8_t, 32>, 16> n_V_big_endian = ";
+		write_table(file, entry.first, "\t");
+		file << ";\n};\n";
+	}
+	file << "\nusing Candidates = std::tuple<";
+	for(size_t i=0;i<optimizer.archive.front.size();i++) file << (i ? ", " : "") << "Candidate" << i;
+	file << ">;\n";
+	std::cout << std::endl;
+	return file ? 0 : 1;
+}
+
+// keys per hash_many call of -benchmark
+static constexpr size_t benchmark_keys = 1024;
+
+// hashes/s of schedule: compiled into hash_many, and through schedule_hash as the searches run it, and MB/s of the production
+// transform compiled for it. All of them have to give the same keystream
+template<FullTimePad::Version version, typename Schedule>
+bool benchmark_schedule(const std::string &name)
+{
+	std::vector<uint8_t> keys(benchmark_keys * FullTimePad::keysize), out(keys.size());
+	std::vector<uint64_t> indexes(benchmark_keys, 0);
+	for(size_t i=0;i<benchmark_keys;i++) gen_rand_key(keys.data() + i*FullTimePad::keysize, i);
+
+	auto rate = [](auto &&run) {
+		uint64_t hashes = 0;
+		const auto start = std::chrono::steady_clock::now();
+		double seconds = 0;
+		for(;seconds < 0.5;seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()) hashes += run();
+		return hashes / seconds;
+	};
+	const double compiled = rate([&]() {
+		FullTimePad::hash_many<version, Schedule>(keys.data(), indexes.data(), out.data(), benchmark_keys);
+		return benchmark_keys;
+	});
+	size_t next = 0;
+	volatile uint8_t sink = 0; // keeps the unread hashes
+	const double runtime = rate([&]() {
+		std::array<uint8_t, 32> key;
+		memcpy(key.data(), keys.data() + (next++ % benchmark_keys)*FullTimePad::keysize, FullTimePad::keysize);
+		sink = sink ^ schedule_hash(version, key, Schedule::n_V_big_endian)[0];
+		return size_t(1);
+	});
+
+	// a message of benchmark_keys blocks with the first key, the keystream of block i is its hash at encryption index i
+	FullTimePad fulltimepad(keys.data());
+	std::vector<uint8_t> message(benchmark_keys * FullTimePad::keysize, 0);
+	const double transformed = rate([&]() {
+		fulltimepad.transform<version, Schedule>(message.data(), message.data(), message.size(), 0);
+		return message.size();
+	}) / 1e6;
+
+	bool same = true;
+	std::array<uint8_t, 32> first;
+	memcpy(first.data(), keys.data(), FullTimePad::keysize);
+	std::fill(message.begin(), message.end(), 0);
+	fulltimepad.transform<version, Schedule>(message.data(), message.data(), message.size(), 0);
+	for(size_t i=0;i<benchmark_keys;i++) {
+		std::array<uint8_t, 32> key;
+		memcpy(key.data(), keys.data() + i*FullTimePad::keysize, FullTimePad::keysize);
+		same &= memcmp(schedule_hash(version, key, Schedule::n_V_big_endian).data(), out.data() + i*FullTimePad::keysize, FullTimePad::keysize) == 0;
+		same &= memcmp(FullTimePad::hash<version>(first, i, Schedule::n_V_big_endian).data(), message.data() + i*FullTimePad::keysize, FullTimePad::keysize) == 0;
+	}
+
+	Fitness fitness;
+	shuffle_cost(Schedule::n_V_big_endian, fitness);
+	printf("%-14s %3d.%d %14.0f %14.0f %14.0f %9u %9u  %s\n", name.c_str(), version/10, version%10, compiled, runtime, transformed,
+	       fitness.shuffles, fitness.cross_lane, same ? "ok" : "MISMATCH");
+	return same;
+}
+
+template<typename Schedule>
+bool benchmark_versions(const std::string &name)
+{
+	bool same = benchmark_schedule<FullTimePad::Version10, Schedule>(name);
+	same &= benchmark_schedule<FullTimePad::Version11, Schedule>(name);
+	same &= benchmark_schedule<FullTimePad::Version20, Schedule>(name);
+	return same;
+}
+
+// the shipped schedule and the candidates compiled in with PERMUTATION_CANDIDATES, in every version
+int benchmark()
+{
+	printf("%-14s %5s %14s %14s %14s %9s %9s\n", "schedule", "", "compiled/s", "run time/s", "transform MB/s", "shuffles", "cross");
+	bool same = benchmark_versions<FullTimePad::DefaultSchedule>("shipped");
+	#ifdef PERMUTATION_CANDIDATES
+	[&]<typename... Candidate>(std::tuple<Candidate...>*) {
+		size_t i = 0;
+		((same &= benchmark_versions<Candidate>("Candidate" + std::to_string(i++))), ...);
+	}(static_cast<Candidates*>(nullptr));
+	#endif
+	std::cout << (same ? "PASSED" : "FAILED") << std::endl;
+	return same ? 0 : 1;
+}
+
+void signal_handler(int) {
+	stop = true;
 }
 
 int main(int argc, char *argv[])
 {
 	std::cout << "\n----------DEPRECATED FILE - NO LONGER NEEDED AS CONFUSION AND DIFFUSION ARE ALREADY MAXIMIZED----------\n\n";
-	CollisionCalculation collision_calc;
 
-	// parse user input to determine how the collision calculation should be performed
-	if(argc > 1 && strcmp(argv[1], "-r") == 0) { // for random key: run with ./best_permutation -r
-		collision_calc = random_key;
-	} else {
-		collision_calc = incrementing_key; // for incrementing key (pattern): run with ./best_permutation
+	// parse user input to determine how the collision calculation should be performed, and which ranks to search
+	Options options;
+	options.seed = std::random_device{}() | uint64_t(std::random_device{}()) << 32;
+	OptimizerOptions optimizer;
+	std::vector<std::string> merge_paths;
+	for(int i=1;i<argc;i++) {
+		if(strcmp(argv[i], "-r") == 0) options.collision_calc = random_key;
+		else if(strcmp(argv[i], "-2.0") == 0) options.version = FullTimePad::Version20;
+		else if(strcmp(argv[i], "-1.1") == 0) options.version = FullTimePad::Version11;
+		else if(strcmp(argv[i], "-1.0") == 0) options.version = FullTimePad::Version10;
+		else if(strcmp(argv[i], "-benchmark") == 0) return benchmark();
+		else if(strcmp(argv[i], "-t") == 0 && i+1 < argc) options.threads = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+		else if(strcmp(argv[i], "-s") == 0 && i+1 < argc) options.seed = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-p") == 0 && i+1 < argc) options.process = strtoull(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-P") == 0 && i+1 < argc) options.processes = std::max(1ull, strtoull(argv[++i], nullptr, 10));
+		else if(strcmp(argv[i], "-c") == 0 && i+1 < argc) options.checkpoint = argv[++i];
+		else if(strcmp(argv[i], "-i") == 0 && i+1 < argc) options.interval = strtoul(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-resume") == 0) options.resume = true;
+		else if(strcmp(argv[i], "-merge") == 0) {
+			while(i+1 < argc) merge_paths.push_back(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-anneal") == 0 && i+1 < argc) optimizer.anneal = strtoull(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-genetic") == 0 && i+1 < argc) optimizer.generations = strtoull(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-population") == 0 && i+1 < argc) optimizer.population = strtoull(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-w") == 0 && i+1 < argc) optimizer.weight = strtod(argv[++i], nullptr);
+		else if(strcmp(argv[i], "-o") == 0 && i+1 < argc) optimizer.archive = argv[++i];
+		else {
+			std::cerr << "usage: " << argv[0] << " [-r] [-1.0|-1.1|-2.0] [-t threads] [-s seed] [-p process -P processes] [-c checkpoint file] [-i seconds] [-resume]" << std::endl
+			          << "       " << argv[0] << " -merge checkpoint files" << std::endl
+			          << "       " << argv[0] << " [-anneal steps] [-genetic generations] [-population size] [-w weight per shuffle] [-o archive file] [-1.0|-1.1|-2.0] [-t threads] [-s seed]" << std::endl
+			          << "       " << argv[0] << " -benchmark" << std::endl;
+			return 1;
+		}
 	}
-
-	double best_collision_rate = UINT32_MAX;
-	uint32_t permutations_count = 0; // number of permutations tried
-	uint8_t **n_V = new uint8_t*[16];
-	uint8_t **placeholder = new uint8_t*[16];
-	constexpr std::array<std::array<uint8_t, 32>, 16> n_V_const = FullTimePadTest::get_n_V();
-	for(uint8_t i=0;i<16;i++) {
-		n_V[i] = new uint8_t[32];
-   		placeholder[i] = new uint8_t[32];
-		memcpy(n_V[i], &n_V_const[i][0], 32);
+	if(options.process >= options.processes) {
+		std::cerr << "process " << options.process << " of " << options.processes << " doesn't exist" << std::endl;
+		return 1;
 	}
+
+	// For incrementing key (pattern): run with ./best_permutation
+	// For random key: run with ./best_permutation -r, the same seed (-s) compares every permutation with the same key
+	// On several machines: ./best_permutation -p 0 -P 4 -c 0.checkpoint ... ./best_permutation -p 3 -P 4 -c 3.checkpoint,
+	// then ./best_permutation -merge 0.checkpoint 1.checkpoint 2.checkpoint 3.checkpoint
+	// Ctrl-C writes a checkpoint, -resume continues from it
+	// Whole new schedules instead of row orders: ./best_permutation -anneal 2000 -genetic 200 -w 0.01,
+	// Ctrl-C stops the optimizer early and still writes the archive
+	// Speed of the archived schedules compiled into the kernels: make CANDIDATES=permutation_archive.h && ./best_permutation -benchmark
+	if(!merge_paths.empty()) return merge(merge_paths);
+
 	// catch signal interrupt
 	signal(SIGINT, signal_handler);
-	new_n_V(n_V, placeholder, best_collision_rate, permutations_count, collision_calc);
-
-	for(uint8_t i=0;i<16;i++) {
-		delete[] n_V[i];
-		delete[] placeholder[i];
+	if(optimizer.anneal || optimizer.generations) {
+		optimizer.version = options.version;
+		optimizer.seed = options.seed;
+		optimizer.threads = options.threads;
+		return optimize(optimizer);
 	}
-	delete[] n_V;
-	delete[] placeholder;
-	std::cout << std::endl << "PROGRAM FINSIHED, ALL PERMUTATIONS TRIED";
-	return 0;
+	return new_n_V(options);
 }
-#pragma GCC diagnostic pop
 
 #endif /* BEST_PERMUTATION_CPP */
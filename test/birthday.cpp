@@ -0,0 +1,395 @@
+/*
+ * @Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * Birthday-bound collisions of hash<version> truncated to t bits, by parallel Pollard rho with distinguished points
+ * (van Oorschot and Wiener, "Parallel Collision Search with Cryptanalytic Applications").
+ * f(x) = first t bits of hash(base key with x in its first 8 bytes). Walks x, f(x), f(f(x)), ... run until a distinguished point
+ * (low d bits 0), which is stored with the start of its walk. Two walks that reach the same distinguished point merged somewhere,
+ * the merge is a collision f(a) == f(b) with a != b. Only 1 in 2^d points is stored, so the memory is a fraction of the work
+ * and the number of collisions grows quadratically with the number of steps.
+ * With -T n targets every step is also checked against n stored outputs: a multi-target preimage search, one hit per 2^t/n steps.
+ */
+
+#include <stdint.h>
+#include <iostream>
+#include <random>
+#include <signal.h>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+#include "../fulltimepad.h"
+
+static std::atomic<bool> stop{false};
+
+void signal_handler(int) {
+	stop = true;
+}
+
+// walks stepped together, one hash_many call per step
+static constexpr size_t lanes = 64;
+
+// search settings, from the command line
+struct Options
+{
+	unsigned int bits = 32; // t
+	unsigned int distinguished = 0; // d, 0 picks one from bits and memory
+	uint64_t collisions = 16; // stop after this many collisions (or target hits)
+	uint64_t max_steps = UINT64_MAX;
+	size_t memory = 64; // MiB for the distinguished point table
+	uint64_t targets = 0; // multi-target search against this many outputs, 0 for collisions
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	uint64_t seed = 0;
+};
+
+// splitmix64 of (seed, stream, counter), see collision.cpp
+static inline uint64_t counter_rng(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+	uint64_t z = seed + stream * 0x9e3779b97f4a7c15 + (counter + 1) * 0xd1b54a32d192ed03;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+// open-addressing table of t-bit values, linear probing. 16 bytes per entry: the value and the start of its walk,
+// for the targets the index of the target. UINT64_MAX marks an empty entry, so that value (t = 64 only) isn't stored
+static constexpr uint64_t table_empty = UINT64_MAX;
+
+struct Table
+{
+	std::vector<uint64_t> tags, data;
+	uint64_t mask;
+	size_t used = 0;
+
+	explicit Table(size_t capacity) {
+		size_t n = 1;
+		while(n < capacity) n <<= 1;
+		tags.assign(n, table_empty);
+		data.assign(n, 0);
+		mask = n - 1;
+	}
+
+	static inline uint64_t slot(uint64_t value) {
+		return counter_rng(value, 0, 0);
+	}
+
+	// data of value, or false
+	bool find(uint64_t value, uint64_t &out) const {
+		for(uint64_t i=slot(value)&mask;tags[i]!=table_empty;i=(i+1)&mask) {
+			if(tags[i] == value) {
+				out = data[i];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// insert value or return the data it already has. false if the table is 3/4 full
+	bool insert(uint64_t value, uint64_t in, uint64_t &out, bool &found) {
+		found = false;
+		if(value == table_empty) return true;
+		uint64_t i = slot(value) & mask;
+		for(;tags[i]!=table_empty;i=(i+1)&mask) {
+			if(tags[i] == value) {
+				out = data[i];
+				found = true;
+				return true;
+			}
+		}
+		if(4*(used+1) > 3*tags.size()) return false;
+		tags[i] = value;
+		data[i] = in;
+		used++;
+		return true;
+	}
+};
+
+// f: keys are the base key with x in the first 8 bytes (big endian), the output is the first t bits of the hash
+template<FullTimePad::Version version>
+class Function
+{
+	private:
+			uint8_t base[FullTimePad::keysize];
+			unsigned int bits;
+
+	public:
+			Function(uint64_t seed, unsigned int bits) : bits(bits) {
+				for(uint8_t i=0;i<4;i++) {
+					const uint64_t word = counter_rng(seed, UINT64_MAX, i);
+					memcpy(base + i*8, &word, 8);
+				}
+			}
+
+			void key(uint8_t *key, uint64_t x) const {
+				memcpy(key, base, FullTimePad::keysize);
+				for(uint8_t j=0;j<8;j++) key[j] = x >> (56 - 8*j);
+			}
+
+			uint64_t truncate(const uint8_t *hash) const {
+				uint64_t y = 0;
+				for(uint8_t j=0;j<8;j++) y = y << 8 | hash[j];
+				return bits == 64 ? y : y >> (64 - bits);
+			}
+
+			// f of n values at once
+			void operator()(const uint64_t *x, uint64_t *y, size_t n, uint8_t *keys, uint8_t *hashes) const {
+				static const uint64_t indexes[lanes] = {}; // the same encryption index for every key
+				for(size_t i=0;i<n;i++) key(keys + i*FullTimePad::keysize, x[i]);
+				FullTimePad::hash_many<version>(keys, indexes, hashes, n);
+				for(size_t i=0;i<n;i++) y[i] = truncate(hashes + i*FullTimePad::keysize);
+			}
+
+			uint64_t operator()(uint64_t x) const {
+				uint8_t k[FullTimePad::keysize], h[FullTimePad::keysize];
+				uint64_t y;
+				(*this)(&x, &y, 1, k, h);
+				return y;
+			}
+};
+
+// state shared by the threads
+struct Search
+{
+	Options options;
+	uint64_t distinguished_mask;
+	uint64_t max_length; // walks longer than this are in a cycle without a distinguished point, and restarted
+
+	std::mutex lock; // table and output
+	Table points;
+	Table targets;
+	std::vector<uint64_t> target_values;
+	std::set<std::pair<uint64_t, uint64_t>> reported; // collisions (min(a,b), max(a,b)) found so far, under lock
+
+	std::atomic<uint64_t> steps{0}, found{0}, walks{0}, merges{0}, repeats{0};
+	std::chrono::steady_clock::time_point start;
+
+	Search(const Options &options, size_t capacity, size_t targets) : options(options), points(capacity), targets(targets) {}
+};
+
+static void print_key(std::ostream &os, const uint8_t *key)
+{
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) os << std::hex << std::setw(2) << std::setfill('0') << int(key[i]);
+	os << std::dec;
+}
+
+// two walks ended in the same distinguished point: walk the longer one ahead by the length difference,
+// then both together until the next values are equal. false if one start lies on the other walk (no collision)
+template<FullTimePad::Version version>
+bool locate(const Function<version> &f, uint64_t a, uint64_t b, uint64_t point, uint64_t max_length, uint64_t &ca, uint64_t &cb)
+{
+	auto length = [&](uint64_t x) {
+		uint64_t n = 1;
+		for(uint64_t y=f(x);y != point && n <= max_length;y=f(y)) n++;
+		return n;
+	};
+	uint64_t la = length(a), lb = length(b);
+	for(;la > lb;la--) a = f(a);
+	for(;lb > la;lb--) b = f(b);
+	if(a == b) return false;
+
+	for(;;) {
+		const uint64_t fa = f(a), fb = f(b);
+		if(fa == fb) {
+			ca = a;
+			cb = b;
+			return true;
+		}
+		a = fa;
+		b = fb;
+	}
+}
+
+template<FullTimePad::Version version>
+void report(Search &search, const Function<version> &f, uint64_t a, uint64_t b, bool target)
+{
+	const uint64_t n = ++search.found;
+	const uint64_t steps = search.steps.load();
+	const double space = std::ldexp(1.0, search.options.bits);
+
+	// expected work: n collisions after about sqrt(2*n*2^t) steps, n target hits after n*2^t/targets steps
+	const double expected = target ? n * space / search.options.targets : std::sqrt(2 * n * space);
+
+	uint8_t ka[FullTimePad::keysize], kb[FullTimePad::keysize];
+	f.key(ka, a);
+	if(target) memcpy(kb, &search.target_values[b * 4], FullTimePad::keysize);
+	else f.key(kb, b);
+
+	// check with FullTimePad objects, independent of hash_many
+	uint8_t ha[FullTimePad::keysize], hb[FullTimePad::keysize];
+	FullTimePad(ka).hash<version>(ha, 0);
+	FullTimePad(kb).hash<version>(hb, 0);
+	const bool verified = f.truncate(ha) == f.truncate(hb) && memcmp(ka, kb, FullTimePad::keysize) != 0;
+
+	std::stringstream ss;
+	ss << std::endl << (target ? "TARGET HIT " : "COLLISION ") << n << "\tsteps: " << steps << "\texpected: " << uint64_t(expected)
+	   << "\tratio: " << std::setprecision(3) << steps / expected << "\t" << (verified ? "verified" : "NOT VERIFIED") << "\n\t";
+	print_key(ss, ka);
+	ss << "\n\t";
+	print_key(ss, kb);
+	ss << "\n\t" << std::hex << f.truncate(ha) << std::dec;
+
+	std::lock_guard<std::mutex> guard(search.lock);
+	std::cout << ss.str() << std::flush;
+	if(n >= search.options.collisions) stop = true;
+}
+
+template<FullTimePad::Version version>
+void search_thread(Search &search, const Function<version> &f, unsigned int t)
+{
+	const uint64_t space_mask = search.options.bits == 64 ? UINT64_MAX : (uint64_t(1) << search.options.bits) - 1;
+	uint64_t start[lanes], x[lanes], y[lanes], length[lanes];
+	std::vector<uint8_t> keys(lanes * FullTimePad::keysize), hashes(lanes * FullTimePad::keysize);
+
+	// every walk starts at its own stream of the counter RNG
+	uint64_t next_walk = 0;
+	auto restart = [&](size_t i) {
+		start[i] = x[i] = counter_rng(search.options.seed, t, next_walk++) & space_mask;
+		length[i] = 0;
+		search.walks.fetch_add(1, std::memory_order_relaxed);
+	};
+	for(size_t i=0;i<lanes;i++) restart(i);
+
+	while(!stop.load(std::memory_order_relaxed) && search.steps.load(std::memory_order_relaxed) < search.options.max_steps) {
+		f(x, y, lanes, keys.data(), hashes.data());
+		search.steps.fetch_add(lanes, std::memory_order_relaxed);
+
+		for(size_t i=0;i<lanes;i++) {
+			length[i]++;
+
+			if(search.options.targets != 0) {
+				uint64_t target;
+				if(search.targets.find(y[i], target)) report(search, f, x[i], target, true);
+			}
+			else if((y[i] & search.distinguished_mask) == 0) {
+				uint64_t other = 0;
+				bool found = false;
+				{
+					std::lock_guard<std::mutex> guard(search.lock);
+					if(!search.points.insert(y[i], start[i], other, found) && !stop) {
+						std::cout << "\ndistinguished point table is full, use more memory (-m) or more distinguished bits (-d)" << std::flush;
+						stop = true;
+					}
+				}
+				uint64_t a, b;
+				if(found && other != start[i]) {
+					search.merges.fetch_add(1, std::memory_order_relaxed);
+					if(locate(f, start[i], other, y[i], search.max_length, a, b)) {
+						// every later walk into the merged path finds the same collision again, it's counted once
+						bool new_collision;
+						{
+							std::lock_guard<std::mutex> guard(search.lock);
+							new_collision = search.reported.insert({std::min(a, b), std::max(a, b)}).second;
+						}
+						if(new_collision) report(search, f, a, b, false);
+						else search.repeats.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+				restart(i);
+				continue;
+			}
+
+			if(length[i] > search.max_length) restart(i);
+			else x[i] = y[i];
+		}
+	}
+}
+
+template<FullTimePad::Version version>
+int birthday(Options options)
+{
+	const size_t capacity = (options.memory << 20) / 16;
+	if(options.distinguished == 0) {
+		// about 4*sqrt(collisions*2^t) steps, with 1 in 2^d stored it should fill no more than half the table
+		const double steps = 4 * std::sqrt(options.collisions * std::ldexp(1.0, options.bits));
+		options.distinguished = std::max(1, int(std::ceil(std::log2(steps / (capacity/2)))));
+	}
+
+	Search search(options, options.targets ? 1 : capacity, options.targets ? options.targets*2 : 1);
+	search.distinguished_mask = (uint64_t(1) << options.distinguished) - 1;
+	search.max_length = uint64_t(20) << options.distinguished;
+	const Function<version> f(options.seed, options.bits);
+
+	// targets: outputs of random keys that aren't keys of f
+	if(options.targets != 0) {
+		search.target_values.resize(options.targets * 4);
+		for(uint64_t i=0;i<options.targets;i++) {
+			uint8_t *key = reinterpret_cast<uint8_t*>(&search.target_values[i * 4]);
+			for(uint8_t j=0;j<4;j++) search.target_values[i*4 + j] = counter_rng(options.seed, UINT64_MAX - 1, i*4 + j);
+			uint8_t hash[FullTimePad::keysize];
+			FullTimePad(key).hash<version>(hash, 0);
+			uint64_t existing;
+			bool found;
+			search.targets.insert(f.truncate(hash), i, existing, found);
+		}
+	}
+
+	std::cout << "BIRTHDAY - TRANSFORMATION ALGORTIHM " << version/10 << "." << version%10 << " - " << options.bits << " BITS, "
+	          << (options.targets ? std::to_string(options.targets) + " TARGETS" : std::to_string(options.distinguished) + " DISTINGUISHED BITS")
+	          << ", " << options.threads << " THREADS, SEED " << options.seed << std::flush;
+
+	search.start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for(unsigned int t=0;t<options.threads;t++) threads.emplace_back(search_thread<version>, std::ref(search), std::cref(f), t);
+	for(std::thread &thread : threads) thread.join();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - search.start).count();
+	std::cout << std::endl << "\nsteps: " << search.steps << "\t" << uint64_t(search.steps / seconds) << " steps/s\twalks: " << search.walks
+	          << "\tdistinguished points: " << search.points.used << "\tmerges: " << search.merges << "\tfound: " << search.found
+	          << "\trepeated: " << search.repeats << std::endl;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	signal(SIGINT, signal_handler);
+
+	Options options;
+	options.seed = std::random_device{}() | uint64_t(std::random_device{}()) << 32;
+	int version = 10; // default use version 1.0
+	for(int i=1;i<argc;i++) {
+		if(strcmp(argv[i], "-2.0") == 0) version = 20;
+		else if(strcmp(argv[i], "-1.1") == 0) version = 11;
+		else if(strcmp(argv[i], "-1.0") == 0) version = 10;
+		else if(strcmp(argv[i], "-b") == 0 && i+1 < argc) options.bits = std::clamp(strtoul(argv[++i], nullptr, 10), 8ul, 64ul);
+		else if(strcmp(argv[i], "-d") == 0 && i+1 < argc) options.distinguished = std::min(strtoul(argv[++i], nullptr, 10), 32ul);
+		else if(strcmp(argv[i], "-k") == 0 && i+1 < argc) options.collisions = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-n") == 0 && i+1 < argc) options.max_steps = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-m") == 0 && i+1 < argc) options.memory = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+		else if(strcmp(argv[i], "-T") == 0 && i+1 < argc) options.targets = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-t") == 0 && i+1 < argc) options.threads = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+		else if(strcmp(argv[i], "-s") == 0 && i+1 < argc) options.seed = strtoull(argv[++i], nullptr, 0);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-1.0|-1.1|-2.0] [-b bits] [-d distinguished bits] [-k collisions] [-n max steps] [-m MiB] [-T targets] [-t threads] [-s seed]" << std::endl;
+			return 1;
+		}
+	}
+
+	// e.g. ./birthday -2.0 -b 40 -k 100 for 100 collisions of the first 40 bits of Version 2.0
+	// ./birthday -2.0 -b 32 -T 65536 for hits on 65536 outputs at once
+	if(version == 20) return birthday<FullTimePad::Version20>(options);
+	if(version == 11) return birthday<FullTimePad::Version11>(options);
+	return birthday<FullTimePad::Version10>(options);
+}
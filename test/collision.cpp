@@ -22,192 +22,352 @@
 #include <signal.h>
 #include <fstream>
 #include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <stdio.h>
 
 #include "../fulltimepad.h"
 
-static bool doprint = false; // print highest collision and keys and exit
+// stop the search, write a checkpoint and the highest collision, then exit
+static std::atomic<bool> stop{false};
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-parameter"
-void signal_handler(int sig) {
-	doprint = true;
+void signal_handler(int) {
+	stop = true;
 }
 
-// test how many bytes of transformed(k1) = transformed(k2). the highest number should be kept.
-void test_collision(uint8_t *k1, uint8_t *k2, double &highest_collision)
+// candidates hashed per hash_many call
+static constexpr uint64_t batch = 64;
+
+// search settings, from the command line
+struct Options
 {
-	double collision = 0;
-	for(uint8_t i=0;i<FullTimePad::keysize;i++) {
-		if(k1[i] == k2[i]) {
-			collision++;
-		}
-	}
-	collision/=32; // get the rate
-	if(highest_collision < collision) {
-		highest_collision = collision;
+	bool random = false; // pairs of random keys, or a random key against incremented keys
+	uint64_t seed = 0;
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	uint64_t limit = UINT64_MAX; // candidates 0 to limit-1
+	std::string checkpoint = "collision.checkpoint";
+	unsigned int interval = 60; // seconds between checkpoints
+	bool resume = false;
+};
+
+// counter-based RNG: word counter of stream is a hash of (seed, stream, counter), so every position can be computed directly.
+// Each candidate is its own stream, so the keys don't depend on the thread that hashes them and a resumed search
+// continues with exactly the keys it would have had
+static inline uint64_t counter_rng(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+	// splitmix64 finalizer
+	uint64_t z = seed + stream * 0x9e3779b97f4a7c15 + (counter + 1) * 0xd1b54a32d192ed03;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+// 32-byte key number stream of the seed
+static void rng_key(uint8_t *key, uint64_t seed, uint64_t stream)
+{
+	for(uint8_t i=0;i<4;i++) {
+		const uint64_t word = counter_rng(seed, stream, i);
+		memcpy(key + i*8, &word, 8);
 	}
 }
 
-// generate a random 32-byte key (not cryptographically secure but will be enough for testing)
-void gen_rand_key(uint8_t *key)
+// number of equal bytes of transformed(k1) and transformed(k2). the highest number should be kept.
+static inline uint8_t test_collision(const uint8_t *k1, const uint8_t *k2)
 {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<uint8_t> dist(0, 0xff);
-	for(uint8_t i=0;i<32;i++) key[i] = dist(gen);
+	uint8_t collision = 0;
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) {
+		collision += k1[i] == k2[i];
+	}
+	return collision;
 }
 
-// brute-force the key by generating 2 random keys
-template<FullTimePad::Version version>
-void brute_force_random()
+// candidates [begin, end) of one thread. Idle threads steal the upper half of another thread's range
+struct alignas(64) WorkRange
 {
-	std::ofstream textfile("collision_report.txt");
+	std::mutex lock;
+	uint64_t begin = 0, end = 0; // not taken yet
+	uint64_t flight_begin = 0, flight_end = 0; // taken, being hashed
+	std::atomic<uint64_t> done{0}; // candidates hashed by this thread
+};
+
+// state shared by the threads of a search
+struct Search
+{
+	Options options;
+	std::unique_ptr<WorkRange[]> ranges;
 
-	uint8_t *k1 = new uint8_t[32];
-	uint8_t *k2 = new uint8_t[32];
-	double highest_collision = 0; // highest collision rate. If 1 achieved, the encryption algorithm failed to provide security.
-	double prev_highest_collision = 0;
-	uint64_t iteration = 0; // how many iterations
-	while(true) {
-		if(doprint) {
-			std::stringstream ss;
-			ss << std::endl << "\nHighest Collision Rate: " << highest_collision*100 << "%\ti: " << iteration << std::endl;
-			std::cout << ss.str() << std::flush;
-			textfile << ss.str() << std::flush;
-
-			// cleanup
-			delete[] k1;
-			delete[] k2;
-			textfile.close();
-			exit(0);
-		}
+	// ranges that aren't owned by a thread yet: the initial split, or the ranges of a checkpoint
+	std::mutex pending_lock;
+	std::vector<std::pair<uint64_t, uint64_t>> pending;
 
-		// generate 2 random keys
-		gen_rand_key(k1);
-		gen_rand_key(k2);
+	// held shared while a range moves between pending and the threads, exclusively while a checkpoint is written
+	std::shared_mutex moving;
 
-		// generate transformed(key)
-		FullTimePad fulltimepad1 = FullTimePad(k1);
-		FullTimePad fulltimepad2 = FullTimePad(k2);
-		fulltimepad1.hash<version>(k1, 0); // since keys are unieqe each time, encryption index can stay the same
-		fulltimepad2.hash<version>(k2, 0);
+	// highest collision in bytes, the first candidate that reached it, and the candidates of earlier runs
+	std::mutex best_lock;
+	std::atomic<uint8_t> highest{0};
+	uint64_t best = 0;
+	uint64_t previous_done = 0;
 
-		test_collision(k1, k2, highest_collision);
+	std::ofstream report;
+};
 
-		if(highest_collision > prev_highest_collision) {
-			std::stringstream ss;
-			ss << std::endl << "Higher Collision Rate: " << highest_collision*100 << "%\ti: " << iteration;
-			std::cout << ss.str() << std::flush;
-			textfile << ss.str() << std::flush;
-		}
+static void log(Search &search, const std::string &text)
+{
+	std::cout << text << std::flush;
+	search.report << text << std::flush;
+}
 
-		if(highest_collision == 1) {
-			std::stringstream ss;
-			ss << std::endl << "\nMAJOR PROBLEM: ENCRYPTION ALGORITHM DEFECTIVE --- Collision Rate: " << highest_collision*100 << "%";
-			std::cout << ss.str() << std::flush;
-			textfile << ss.str() << std::flush;
+// the next batch of thread t: from its own range, a pending range or stolen from another thread.
+// false once every candidate is taken
+static bool take(Search &search, unsigned int t, uint64_t &begin, uint64_t &end)
+{
+	WorkRange &own = search.ranges[t];
+	for(;;) {
+		{
+			std::lock_guard<std::mutex> guard(own.lock);
+			if(own.begin < own.end) {
+				begin = own.begin;
+				end = own.end - own.begin > batch ? own.begin + batch : own.end;
+				own.begin = end;
+				own.flight_begin = begin;
+				own.flight_end = end;
+				return true;
+			}
+		}
 
+		std::shared_lock<std::shared_mutex> move(search.moving);
+		std::pair<uint64_t, uint64_t> next = {0, 0};
+		{
+			std::lock_guard<std::mutex> guard(search.pending_lock);
+			if(!search.pending.empty()) {
+				next = search.pending.back();
+				search.pending.pop_back();
+			}
+		}
 
-			// cleanup
-			delete[] k1;
-			delete[] k2;
-			textfile.close();
-			exit(0);
+		// steal the upper half of the next thread's range with candidates left, or all of it when it's small
+		if(next.first == next.second) {
+			for(unsigned int i=1;i<search.options.threads && next.first == next.second;i++) {
+				WorkRange &victim = search.ranges[(t+i) % search.options.threads];
+				std::lock_guard<std::mutex> guard(victim.lock);
+				if(victim.begin >= victim.end) continue;
+				const uint64_t middle = victim.end - victim.begin >= 2*batch ? victim.begin + (victim.end - victim.begin)/2 : victim.begin;
+				next = {middle, victim.end};
+				victim.end = middle;
+			}
 		}
+		if(next.first == next.second) return false;
 
-		prev_highest_collision = highest_collision;
-		iteration++;
+		std::lock_guard<std::mutex> guard(own.lock);
+		own.begin = next.first;
+		own.end = next.second;
 	}
-	delete[] k1;
-	delete[] k2;
-	textfile.close();
 }
 
-// brute-force the key by generating 1 random key and incrementing it till it's similiar
-template<FullTimePad::Version version>
-void brute_force_incr()
+static void finish(Search &search, unsigned int t, uint64_t n)
 {
-	std::ofstream textfile("collision_report.txt");
-
-	uint8_t *k1 = new uint8_t[32];
-	uint8_t *transformed_k1 = new uint8_t[32];
-	uint8_t *transformed_k2 = new uint8_t[32];
-	uint8_t *k2 = new uint8_t[32];
-	double highest_collision = 0; // highest collision rate. If 1 achieved, the encryption algorithm failed to provide security.
-	double prev_highest_collision = 0;
-	uint64_t iteration = 0; // how many iterations
+	WorkRange &own = search.ranges[t];
+	std::lock_guard<std::mutex> guard(own.lock);
+	own.flight_begin = own.flight_end = 0;
+	own.done.fetch_add(n, std::memory_order_relaxed);
+}
 
-	// generate 2 random keys
-	gen_rand_key(k1);
-	memcpy(k2, k1, FullTimePad::keysize);
+// keep the highest collision of all threads, and report a new one
+static void update_highest(Search &search, uint8_t collision, uint64_t candidate)
+{
+	if(collision <= search.highest.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> guard(search.best_lock);
+	if(collision <= search.highest.load(std::memory_order_relaxed)) return;
+	search.highest = collision;
+	search.best = candidate;
+
+	std::stringstream ss;
+	ss << std::endl << "Higher Collision Rate: " << collision*100.0/FullTimePad::keysize << "%\ti: " << candidate;
+	if(collision == FullTimePad::keysize) {
+		ss << std::endl << "\nMAJOR PROBLEM: ENCRYPTION ALGORITHM DEFECTIVE --- Collision Rate: 100%";
+		stop = true;
+	}
+	log(search, ss.str());
+}
 
-	// generate transformed(k1) once
-	FullTimePad fulltimepad1 = FullTimePad(k1);
-	fulltimepad1.hash<version>(transformed_k1, 0);
+// random: candidate i is the pair of random keys of streams 2i and 2i+1.
+// incremented: candidate i is the random key of stream UINT64_MAX with i in its first 8 bytes (big endian), against the key itself
+template<FullTimePad::Version version>
+void search_thread(Search &search, unsigned int t)
+{
+	const uint64_t keys_per_candidate = search.options.random ? 2 : 1;
+	std::vector<uint8_t> keys(batch * keys_per_candidate * FullTimePad::keysize);
+	std::vector<uint8_t> transformed(keys.size());
+	std::vector<uint64_t> indexes(batch * keys_per_candidate, 0); // keys are unieqe each time, so encryption index can stay the same
+
+	uint8_t k1[FullTimePad::keysize], transformed_k1[FullTimePad::keysize];
+	rng_key(k1, search.options.seed, UINT64_MAX);
+	FullTimePad::hash_many<version>(k1, indexes.data(), transformed_k1, 1);
+	uint64_t k1_prefix = 0; // the candidate that is k1 itself
+	for(uint8_t j=0;j<8;j++) k1_prefix = k1_prefix << 8 | k1[j];
+
+	uint64_t begin, end;
+	while(!stop.load(std::memory_order_relaxed) && take(search, t, begin, end)) {
+		const uint64_t n = end - begin;
+		for(uint64_t i=0;i<n;i++) {
+			uint8_t *key = keys.data() + i*keys_per_candidate*FullTimePad::keysize;
+			if(search.options.random) {
+				rng_key(key, search.options.seed, 2*(begin+i));
+				rng_key(key + FullTimePad::keysize, search.options.seed, 2*(begin+i)+1);
+			}
+			else {
+				memcpy(key, k1, FullTimePad::keysize);
+				for(uint8_t j=0;j<8;j++) key[j] = (begin+i) >> (56 - 8*j);
+			}
+		}
 
-	while(true) {
-		if(doprint) {
-			std::stringstream ss;
-			ss << std::endl << "\nHighest Collision Rate: " << highest_collision*100 << "%\ti: " << iteration << std::endl;
-			std::cout << ss.str() << std::flush;
-			textfile << ss.str() << std::flush;
-
-			// cleanup
-			delete[] k1;
-			delete[] k2;
-			delete[] transformed_k1;
-			delete[] transformed_k2;
-			textfile.close();
-			exit(0);
+		FullTimePad::hash_many<version>(keys.data(), indexes.data(), transformed.data(), n*keys_per_candidate);
+
+		uint8_t highest = 0;
+		uint64_t candidate = 0;
+		for(uint64_t i=0;i<n;i++) {
+			const uint8_t *k = transformed.data() + i*keys_per_candidate*FullTimePad::keysize;
+			const uint8_t collision = test_collision(search.options.random ? k + FullTimePad::keysize : transformed_k1, k);
+			if(collision > highest && (search.options.random || begin+i != k1_prefix)) {
+				highest = collision;
+				candidate = begin+i;
+			}
 		}
+		update_highest(search, highest, candidate);
+		finish(search, t, n);
+	}
+}
+
+static uint64_t done(Search &search)
+{
+	uint64_t n = search.previous_done;
+	for(unsigned int t=0;t<search.options.threads;t++) n += search.ranges[t].done.load(std::memory_order_relaxed);
+	return n;
+}
 
-		// increment k2 starting from 0 (64-bits is enough)
-		k2[0] = iteration >> 56;
-		k2[1] = iteration >> 48;
-		k2[2] = iteration >> 40;
-		k2[3] = iteration >> 32;
-		k2[4] = iteration >> 24;
-		k2[5] = iteration >> 16;
-		k2[6] = iteration >> 8;
-		k2[7] = iteration;
+// write the candidates still to do and the highest collision. Written to a temporary file and renamed,
+// so an interrupted write leaves the previous checkpoint
+template<FullTimePad::Version version>
+bool write_checkpoint(Search &search)
+{
+	std::unique_lock<std::shared_mutex> move(search.moving);
+	std::vector<std::pair<uint64_t, uint64_t>> todo;
+	{
+		std::lock_guard<std::mutex> guard(search.pending_lock);
+		todo = search.pending;
+	}
+	for(unsigned int t=0;t<search.options.threads;t++) {
+		WorkRange &range = search.ranges[t];
+		std::lock_guard<std::mutex> guard(range.lock);
+		if(range.flight_begin < range.flight_end) todo.push_back({range.flight_begin, range.flight_end});
+		if(range.begin < range.end) todo.push_back({range.begin, range.end});
+	}
 
-		// generate transformed(k2)
-		FullTimePad fulltimepad2 = FullTimePad(k2);
-		fulltimepad2.hash<version>(transformed_k2, 0); // testing brute-forcing so encryption index should be same
+	const std::string tmp = search.options.checkpoint + ".tmp";
+	std::ofstream file(tmp);
+	{
+		std::lock_guard<std::mutex> guard(search.best_lock);
+		file << "version " << int(version) << "\nrandom " << search.options.random << "\nseed " << search.options.seed
+		     << "\nhighest " << int(search.highest) << "\nbest " << search.best << "\ndone " << done(search) << "\nranges " << todo.size() << "\n";
+	}
+	move.unlock();
+	for(const auto &range : todo) file << range.first << " " << range.second << "\n";
+	file.close();
+	return file && rename(tmp.c_str(), search.options.checkpoint.c_str()) == 0;
+}
 
-		// compare the transformed keys
-		test_collision(transformed_k1, transformed_k2, highest_collision);
+template<FullTimePad::Version version>
+bool read_checkpoint(Search &search)
+{
+	std::ifstream file(search.options.checkpoint);
+	std::string field;
+	int file_version = 0, highest = 0;
+	size_t n = 0;
+	file >> field >> file_version >> field >> search.options.random >> field >> search.options.seed >> field >> highest
+	     >> field >> search.best >> field >> search.previous_done >> field >> n;
+	if(!file || file_version != version) return false;
+
+	search.highest = highest;
+	search.pending.resize(n);
+	for(auto &range : search.pending) file >> range.first >> range.second;
+	return bool(file);
+}
 
-		if(highest_collision > prev_highest_collision) {
-			std::stringstream ss;
-			ss << std::endl << "Higher Collision Rate: " << highest_collision*100 << "%\ti: " << iteration;
-			std::cout << ss.str() << std::flush;
-			textfile << ss.str() << std::flush;
-		}
+// version a checkpoint was written with, 0 if it can't be read. A resumed search runs with it
+int checkpoint_version(const std::string &path)
+{
+	std::ifstream file(path);
+	std::string field;
+	int version = 0;
+	file >> field >> version;
+	return file && (version == 10 || version == 11 || version == 20) ? version : 0;
+}
 
-		if(highest_collision == 1) {
+// search with all threads until every candidate is done or SIGINT. Checkpoints every interval seconds and at the end
+template<FullTimePad::Version version>
+int brute_force(Options options)
+{
+	Search search;
+	search.options = options;
+	search.ranges = std::make_unique<WorkRange[]>(options.threads);
+
+	if(options.resume) {
+		if(!read_checkpoint<version>(search)) {
+			std::cerr << "\ncan't resume from " << options.checkpoint << std::endl;
+			return 1;
+		}
+	}
+	else {
+		// one range per thread to start with
+		for(unsigned int t=0;t<options.threads;t++) {
+			search.pending.push_back({options.limit/options.threads*t, t+1 == options.threads ? options.limit : options.limit/options.threads*(t+1)});
+		}
+	}
+	search.report.open("collision_report.txt", options.resume ? std::ios::app : std::ios::trunc);
+	std::cout << "RUNNING " << (search.options.random ? "RANDOM KEY" : "INCREMENTING KEY") << " - TRANSFORMATION ALGORTIHM " << version/10 << "." << version%10
+	          << " - " << options.threads << " THREADS, SEED " << search.options.seed << std::flush;
+
+	std::vector<std::thread> threads;
+	for(unsigned int t=0;t<options.threads;t++) threads.emplace_back(search_thread<version>, std::ref(search), t);
+
+	// the threads finish on their own once every candidate is taken
+	std::atomic<unsigned int> running{options.threads};
+	std::thread waiter([&]() {
+		for(std::thread &thread : threads) thread.join();
+		running = 0;
+	});
+
+	auto last = std::chrono::steady_clock::now();
+	uint64_t last_done = done(search);
+	while(running != 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		const auto now = std::chrono::steady_clock::now();
+		if(now - last >= std::chrono::seconds(options.interval)) {
+			const uint64_t n = done(search);
 			std::stringstream ss;
-			ss << std::endl << "\nMAJOR PROBLEM: ENCRYPTION ALGORITHM DEFECTIVE --- Collision Rate: " << highest_collision*100 << "%";
-			std::cout << ss.str() << std::flush;
-			textfile << ss.str() << std::flush;
-
-			// cleanup
-			delete[] k1;
-			delete[] k2;
-			delete[] transformed_k1;
-			delete[] transformed_k2;
-			textfile.close();
-			exit(0);
+			ss << std::endl << "i: " << n << "\t" << uint64_t((n - last_done) / std::chrono::duration<double>(now - last).count()) << " candidates/s";
+			if(!write_checkpoint<version>(search)) ss << "\tcan't write " << options.checkpoint;
+			log(search, ss.str());
+			last = now;
+			last_done = n;
 		}
-
-		prev_highest_collision = highest_collision;
-		iteration++;
 	}
-	delete[] k1;
-	delete[] k2;
-	delete[] transformed_k1;
-	delete[] transformed_k2;
-	textfile.close();
+	waiter.join();
+
+	write_checkpoint<version>(search);
+	std::stringstream ss;
+	ss << std::endl << "\nHighest Collision Rate: " << search.highest*100.0/FullTimePad::keysize << "%\ti: " << done(search) << std::endl;
+	log(search, ss.str());
+	return 0;
 }
 
 int main(int argc, char *argv[])
@@ -216,29 +376,24 @@ int main(int argc, char *argv[])
 	signal(SIGINT, signal_handler);
 
 	// parse user input to determine how the brute-force should be performed (random or incremented)
-	if(argc > 1 && strcmp(argv[1], "-r") == 0) {
-		if((argc > 1 && strcmp(argv[1], "-2.0") == 0) || (argc > 2 && strcmp(argv[2], "-2.0") == 0)) {
-			std::cout << "RUNNING RANDOM KEY - TRANSFORMATION ALGORTIHM 2.0";
-			brute_force_random<FullTimePad::Version20>();
-		} else if((argc > 1 && strcmp(argv[1], "-1.1") == 0) || (argc > 2 && strcmp(argv[2], "-1.1") == 0)) {
-			std::cout << "RUNNING RANDOM KEY - TRANSFORMATION ALGORTIHM 1.1";
-			brute_force_random<FullTimePad::Version11>();
-		} else { // default use version 1.0
-			std::cout << "RUNNING RANDOM KEY - TRANSFORMATION ALGORTIHM 1.0";
-			brute_force_random<FullTimePad::Version10>();
+	Options options;
+	options.seed = std::random_device{}() | uint64_t(std::random_device{}()) << 32;
+	int version = 10; // default use version 1.0
+	for(int i=1;i<argc;i++) {
+		if(strcmp(argv[i], "-r") == 0) options.random = true;
+		else if(strcmp(argv[i], "-2.0") == 0) version = 20;
+		else if(strcmp(argv[i], "-1.1") == 0) version = 11;
+		else if(strcmp(argv[i], "-1.0") == 0) version = 10;
+		else if(strcmp(argv[i], "-t") == 0 && i+1 < argc) options.threads = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+		else if(strcmp(argv[i], "-s") == 0 && i+1 < argc) options.seed = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-n") == 0 && i+1 < argc) options.limit = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-c") == 0 && i+1 < argc) options.checkpoint = argv[++i];
+		else if(strcmp(argv[i], "-i") == 0 && i+1 < argc) options.interval = strtoul(argv[++i], nullptr, 10);
+		else if(strcmp(argv[i], "-resume") == 0) options.resume = true;
+		else {
+			std::cerr << "usage: " << argv[0] << " [-r] [-1.0|-1.1|-2.0] [-t threads] [-s seed] [-n candidates] [-c checkpoint file] [-i seconds] [-resume]" << std::endl;
+			return 1;
 		}
-	} else {
-		if((argc > 1 && strcmp(argv[1], "-2.0") == 0) || (argc > 2 && strcmp(argv[2], "-2.0") == 0)) {
-			std::cout << "RUNNING INCREMENTING KEY - TRANSFORMATION ALGORTIHM 2.0";
-			brute_force_incr<FullTimePad::Version20>();
-		} else if((argc > 1 && strcmp(argv[1], "-1.1") == 0) || (argc > 2 && strcmp(argv[2], "-1.1") == 0)) {
-			std::cout << "RUNNING INCREMENTING KEY - TRANSFORMATION ALGORTIHM 1.1";
-			brute_force_incr<FullTimePad::Version11>();
-		} else { // default use version 1.0
-			std::cout << "RUNNING INCREMENTING KEY - TRANSFORMATION ALGORTIHM 1.0";
-			brute_force_incr<FullTimePad::Version10>();
-		}
-
 	}
 
 	// To run with random keys (no patterns in input):
@@ -247,6 +402,15 @@ int main(int argc, char *argv[])
 	// Use ./collision -r -1.0 or just ./collision -r
 	// where the number denotes version of transformation algorithm
 	// For non-random keys, remove -r
-
-	return 0;
+	// Ctrl-C writes a checkpoint, ./collision -resume continues from it (with the version it was started with)
+	if(options.resume) {
+		version = checkpoint_version(options.checkpoint);
+		if(version == 0) {
+			std::cerr << "can't resume from " << options.checkpoint << std::endl;
+			return 1;
+		}
+	}
+	if(version == 20) return brute_force<FullTimePad::Version20>(options);
+	if(version == 11) return brute_force<FullTimePad::Version11>(options);
+	return brute_force<FullTimePad::Version10>(options);
 }
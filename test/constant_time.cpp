@@ -0,0 +1,305 @@
+/*
+ * @Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * Constant-time check of the hash and transform kernels, in the style of dudect (Reparaz, Balasch, Verbauwhede, "Dude, is my code constant time?").
+ * Every kernel is timed in cycles on two classes of secret input: a fixed all-zero key/plaintext and random ones, in random order.
+ * A Welch t-test on the two timing distributions (also cropped at several percentiles to cut off interrupts) shows whether the
+ * time depends on the secret data. |t| > 10 is a leak, |t| > 4.5 is suspicious.
+ */
+
+#include <iostream>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <string>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../fulltimepad.h"
+
+// number of percentile crops, on top of the uncropped test
+static constexpr int crops = 20;
+
+// samples per batch. The first batch only sets the crop thresholds
+static constexpr size_t batch_size = 10000;
+
+// a test needs this many samples per class to be reported
+static constexpr double min_samples = 1000;
+
+// |t| above these is a leak or suspicious
+static constexpr double t_leak = 10;
+static constexpr double t_suspicious = 4.5;
+
+// fenced time stamp counter, so the timed code can't move out of the measurement
+static inline uint64_t cycles_begin()
+{
+	#if defined(__x86_64__) || defined(__i386__)
+	_mm_lfence();
+	const uint64_t t = __rdtsc();
+	_mm_lfence();
+	return t;
+	#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+	#endif
+}
+
+static inline uint64_t cycles_end()
+{
+	#if defined(__x86_64__) || defined(__i386__)
+	unsigned int aux;
+	const uint64_t t = __rdtscp(&aux);
+	_mm_lfence();
+	return t;
+	#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+	#endif
+}
+
+// keeps the compiler from removing a computation whose result is never read
+static inline void escape(const void *p)
+{
+	asm volatile("" : : "g"(p) : "memory");
+}
+
+// Welch's t-test of the two classes, updated one sample at a time
+struct TTest
+{
+	double n[2] = {}, mean[2] = {}, m2[2] = {};
+
+	void push(double x, int c) {
+		n[c]++;
+		const double delta = x - mean[c];
+		mean[c] += delta / n[c];
+		m2[c] += delta * (x - mean[c]);
+	}
+
+	double t() const {
+		const double var0 = m2[0] / (n[0] - 1), var1 = m2[1] / (n[1] - 1);
+		return (mean[0] - mean[1]) / sqrt(var0/n[0] + var1/n[1]);
+	}
+};
+
+// result of one kernel
+struct Report
+{
+	std::string name;
+	int cpu; // core the kernel was pinned to
+	uint64_t samples;
+	double mean[2]; // cycles of the fixed and random class
+	double max_t; // largest |t| over all crops
+	int crop; // crop with the largest |t|, -1 is uncropped
+};
+
+// Targets hold the inputs of one batch. prepare(i, random) sets the secret input of sample i to the fixed or a random class,
+// run(i) is the timed call
+
+template<FullTimePad::Version version>
+struct HashTarget
+{
+	std::vector<std::array<uint8_t, FullTimePad::keysize>> keys = std::vector<std::array<uint8_t, FullTimePad::keysize>>(batch_size);
+	uint8_t out[FullTimePad::keysize];
+
+	void prepare(size_t i, bool random, std::mt19937_64 &gen) {
+		for(uint8_t &b : keys[i]) b = random ? gen() : 0;
+	}
+	void run(size_t i) {
+		FullTimePad fulltimepad = FullTimePad(keys[i].data());
+		fulltimepad.hash<version>(out, 0x123456789abcdef);
+	}
+};
+
+// the constexpr hash, called at run time
+template<FullTimePad::Version version>
+struct StaticHashTarget : HashTarget<version>
+{
+	void run(size_t i) {
+		std::array<uint8_t, FullTimePad::keysize> out = FullTimePad::hash<version>(this->keys[i], 0x123456789abcdef);
+		escape(out.data());
+	}
+};
+
+// key and plaintext are secret. length picks the kernel: 33 is a block and a tail, 512 is the multi-block SIMD path
+template<FullTimePad::Version version, size_t length>
+struct TransformTarget
+{
+	std::vector<std::array<uint8_t, FullTimePad::keysize>> keys = std::vector<std::array<uint8_t, FullTimePad::keysize>>(batch_size);
+	std::vector<std::array<uint8_t, length>> pts = std::vector<std::array<uint8_t, length>>(batch_size);
+	uint8_t ct[length];
+
+	void prepare(size_t i, bool random, std::mt19937_64 &gen) {
+		for(uint8_t &b : keys[i]) b = random ? gen() : 0;
+		for(uint8_t &b : pts[i]) b = random ? gen() : 0;
+	}
+	void run(size_t i) {
+		FullTimePad fulltimepad = FullTimePad(keys[i].data());
+		fulltimepad.transform<version>(pts[i].data(), ct, length, 0x123456789abcdef);
+	}
+};
+
+// n keys. 16 are one full AVX-512 batch or two AVX2 batches, 8 one AVX2 batch, 5 the AVX2 batch padded with zero lanes
+template<FullTimePad::Version version, size_t n>
+struct HashManyTarget
+{
+	std::vector<std::array<uint8_t, n*FullTimePad::keysize>> keys = std::vector<std::array<uint8_t, n*FullTimePad::keysize>>(batch_size);
+	uint64_t indexes[n] = {};
+	uint8_t out[n*FullTimePad::keysize];
+
+	void prepare(size_t i, bool random, std::mt19937_64 &gen) {
+		for(uint8_t &b : keys[i]) b = random ? gen() : 0;
+	}
+	void run(size_t i) {
+		FullTimePad::hash_many<version>(keys[i].data(), indexes, out, n);
+	}
+};
+
+// time samples calls of target, fixed and random class in random order
+template<typename Target>
+Report measure(uint64_t samples, int cpu)
+{
+	Target target;
+	std::mt19937_64 gen(std::random_device{}());
+	std::vector<uint8_t> classes(batch_size);
+	std::vector<uint64_t> cycles(batch_size);
+
+	TTest tests[crops + 1]; // tests[0] is uncropped
+	double thresholds[crops];
+
+	Report report = {"", cpu, 0, {}, 0, -1};
+	for(uint64_t batch=0;report.samples < samples;batch++) {
+		for(size_t i=0;i<batch_size;i++) {
+			classes[i] = gen() & 1;
+			target.prepare(i, classes[i], gen);
+		}
+		for(size_t i=0;i<batch_size;i++) {
+			const uint64_t start = cycles_begin();
+			target.run(i);
+			cycles[i] = cycles_end() - start;
+		}
+
+		// the first batch warms up and sets the percentiles 1 - 0.5^(10*(k+1)/crops) of the crops
+		if(batch == 0) {
+			std::vector<uint64_t> sorted = cycles;
+			std::sort(sorted.begin(), sorted.end());
+			for(int k=0;k<crops;k++) thresholds[k] = sorted[size_t((1 - pow(0.5, 10.0*(k+1)/crops)) * (batch_size-1))];
+			continue;
+		}
+
+		for(size_t i=0;i<batch_size;i++) {
+			const double x = cycles[i];
+			tests[0].push(x, classes[i]);
+			for(int k=0;k<crops;k++) {
+				if(x < thresholds[k]) tests[k+1].push(x, classes[i]);
+			}
+		}
+		report.samples += batch_size;
+	}
+
+	report.mean[0] = tests[0].mean[0];
+	report.mean[1] = tests[0].mean[1];
+	for(int k=0;k<=crops;k++) {
+		if(tests[k].n[0] < min_samples || tests[k].n[1] < min_samples) continue;
+		const double t = fabs(tests[k].t());
+		if(t > report.max_t) {
+			report.max_t = t;
+			report.crop = k-1;
+		}
+	}
+	return report;
+}
+
+template<FullTimePad::Version version>
+void add_targets(const char *name, std::vector<std::pair<std::string, std::function<Report(uint64_t, int)>>> &targets)
+{
+	const std::string v = name;
+	targets.push_back({"hash " + v, measure<HashTarget<version>>});
+	targets.push_back({"static hash " + v, measure<StaticHashTarget<version>>});
+	targets.push_back({"transform 33 B " + v, measure<TransformTarget<version, 33>>});
+	targets.push_back({"transform 512 B " + v, measure<TransformTarget<version, 512>>});
+	// 8 blocks and a partial one, the AVX2 kernel and transform_block even when AVX-512 takes the 16-block batches
+	targets.push_back({"transform 273 B " + v, measure<TransformTarget<version, 273>>});
+	targets.push_back({"hash_many 16 " + v, measure<HashManyTarget<version, 16>>});
+	targets.push_back({"hash_many 8 " + v, measure<HashManyTarget<version, 8>>});
+	targets.push_back({"hash_many 5 " + v, measure<HashManyTarget<version, 5>>});
+}
+
+// pin the calling thread, so a kernel isn't migrated between cores with different clocks while it is measured
+static void pin(int cpu)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t samples = 1000000;
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	for(int i=1;i<argc;i++) {
+		if(strcmp(argv[i], "-n") == 0 && i+1 < argc) samples = strtoull(argv[++i], nullptr, 0);
+		else if(strcmp(argv[i], "-t") == 0 && i+1 < argc) threads = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n samples per kernel] [-t threads]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<std::pair<std::string, std::function<Report(uint64_t, int)>>> targets;
+	add_targets<FullTimePad::Version10>("1.0", targets);
+	add_targets<FullTimePad::Version11>("1.1", targets);
+	add_targets<FullTimePad::Version20>("2.0", targets);
+
+	// each thread is pinned to its own core and takes the next kernel
+	std::vector<Report> reports(targets.size());
+	std::atomic<size_t> next = 0;
+	std::vector<std::thread> workers;
+	const unsigned int cpus = std::max(1u, std::thread::hardware_concurrency());
+	for(unsigned int t=0;t<std::min<size_t>(threads, targets.size());t++) {
+		workers.emplace_back([&, t]() {
+			pin(t % cpus);
+			for(size_t i;(i = next++) < targets.size();) {
+				reports[i] = targets[i].second(samples, t % cpus);
+				reports[i].name = targets[i].first;
+			}
+		});
+	}
+	for(std::thread &worker : workers) worker.join();
+
+	bool passed = true;
+	printf("%-20s %4s %10s %12s %12s %8s %5s  %s\n", "kernel", "cpu", "samples", "fixed", "random", "max |t|", "crop", "verdict");
+	for(const Report &r : reports) {
+		const char *verdict = r.max_t > t_leak ? "LEAK" : r.max_t > t_suspicious ? "suspicious" : "constant time";
+		passed &= r.max_t <= t_leak;
+		printf("%-20s %4d %10lu %12.1f %12.1f %8.2f %5d  %s\n", r.name.c_str(), r.cpu, (unsigned long)r.samples, r.mean[0], r.mean[1], r.max_t, r.crop, verdict);
+	}
+	std::cout << std::endl << (passed ? "PASSED" : "FAILED") << std::endl;
+	return passed ? 0 : 1;
+}
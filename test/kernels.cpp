@@ -0,0 +1,538 @@
+/*
+ * @Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * Check that the optimized keystream kernels (SIMD, multi-block) produce exactly the same output as the single-block hash.
+ */
+
+#ifndef KERNELS_CPP
+#define KERNELS_CPP
+
+#include <iostream>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <array>
+#include <bit>
+#include <thread>
+
+#include "../fulltimepad.h"
+#include "../fulltimepad_kernels.h"
+#include "../fulltimepad_stream.h"
+#include "../fulltimepad_prefetch.h"
+#include "../instrumentation.h"
+
+// encryption indexes to start from, 0xfffffffc crosses into the upper 32-bits of the encryption index
+static const uint64_t encryption_indexes[] = {0, 0xfffffffc, 0x123456789abcdef};
+
+// lengths around the 8 and 16 block boundaries of the SIMD kernels
+static const uint32_t lengths[] = {0, 1, 31, 32, 33, 255, 256, 257, 511, 512, 513, 4099};
+
+// reference ciphertext, one hash per 32-byte segment
+template<FullTimePad::Version version>
+std::vector<uint8_t> reference_transform(FullTimePad &fulltimepad, const std::vector<uint8_t> &pt, uint64_t encryption_index)
+{
+	std::vector<uint8_t> ct(pt.size());
+	uint8_t transformed_key[FullTimePad::keysize];
+	for(size_t i=0;i<pt.size();i+=FullTimePad::keysize) {
+		fulltimepad.hash<version>(transformed_key, encryption_index++);
+		for(size_t j=0;j<FullTimePad::keysize && i+j<pt.size();j++) {
+			ct[i+j] = pt[i+j] ^ transformed_key[j];
+		}
+	}
+	return ct;
+}
+
+// check transform against the reference for all lengths and encryption indexes
+template<FullTimePad::Version version>
+bool test_transform()
+{
+	uint8_t key[FullTimePad::keysize];
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) key[i] = i*7+3;
+	FullTimePad fulltimepad = FullTimePad(key);
+
+	bool passed = true;
+	for(uint64_t encryption_index : encryption_indexes) {
+		for(uint32_t length : lengths) {
+			std::vector<uint8_t> pt(length);
+			std::vector<uint8_t> ct(length);
+			for(uint32_t i=0;i<length;i++) pt[i] = i*13;
+
+			fulltimepad.transform<version>(pt.data(), ct.data(), length, encryption_index);
+			if(ct != reference_transform<version>(fulltimepad, pt, encryption_index)) {
+				std::cout << "\nFAILED: length " << length << ", encryption index " << encryption_index;
+				passed = false;
+			}
+
+			// in-place through the span overload must give the same ciphertext
+			std::vector<uint8_t> data = pt;
+			fulltimepad.transform<version>(std::as_writable_bytes(std::span(data)), encryption_index);
+			if(data != ct) {
+				std::cout << "\nFAILED: in-place length " << length << ", encryption index " << encryption_index;
+				passed = false;
+			}
+		}
+	}
+	return passed;
+}
+
+// check parallel_transform against transform with chunks split over several threads
+template<FullTimePad::Version version>
+bool test_parallel_transform()
+{
+	uint8_t key[FullTimePad::keysize];
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) key[i] = i*7+3;
+	FullTimePad fulltimepad = FullTimePad(key);
+
+	// 3 full chunks and a partial one that ends in a partial segment
+	const size_t length = FullTimePad::parallel_chunk*3 + 1000 + 17;
+	std::vector<uint8_t> pt(length);
+	std::vector<uint8_t> ct(length);
+	std::vector<uint8_t> expected(length);
+	for(size_t i=0;i<length;i++) pt[i] = i*13;
+	fulltimepad.transform<version>(pt.data(), expected.data(), length, 0xfffffff0);
+
+	bool passed = true;
+	for(unsigned int threads : {1, 2, 4}) {
+		ThreadPool pool(threads);
+		fulltimepad.parallel_transform<version>(pt.data(), ct.data(), length, 0xfffffff0, pool);
+		if(ct != expected) {
+			std::cout << "\nFAILED: parallel transform with " << threads << " threads";
+			passed = false;
+		}
+	}
+
+	// from inside the tasks of the same pool, every task transforms a quarter of the message
+	ThreadPool pool(4);
+	std::fill(ct.begin(), ct.end(), 0);
+	const size_t quarter = FullTimePad::parallel_chunk;
+	pool.parallel_for(4, [&](size_t q) {
+		const size_t n = q == 3 ? length - 3*quarter : quarter;
+		fulltimepad.parallel_transform<version>(pt.data() + q*quarter, ct.data() + q*quarter, n, 0xfffffff0 + q*quarter/FullTimePad::keysize, pool);
+	});
+	if(ct != expected) {
+		std::cout << "\nFAILED: parallel transform from inside a task";
+		passed = false;
+	}
+	return passed;
+}
+
+// check FullTimePadStream against transform with the message split into pieces of 1 to 1500 bytes
+template<FullTimePad::Version version>
+bool test_stream()
+{
+	uint8_t key[FullTimePad::keysize];
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) key[i] = i*7+3;
+	FullTimePad fulltimepad = FullTimePad(key);
+
+	const size_t length = 20000 + 13;
+	std::vector<uint8_t> pt(length);
+	std::vector<uint8_t> ct(length);
+	std::vector<uint8_t> expected(length);
+	for(size_t i=0;i<length;i++) pt[i] = i*13;
+	fulltimepad.transform<version>(pt.data(), expected.data(), length, 0xfffffffc);
+
+	bool passed = true;
+	for(size_t step : {1, 7, 31, 32, 33, 300, 1500}) {
+		FullTimePadStream<version> stream(fulltimepad, 0xfffffffc);
+		// piece sizes step, step+1, ... so the carry-over starts at every offset of a block
+		for(size_t i=0, piece=step;i<length;i+=piece, piece=piece%1500+1) {
+			stream.update(pt.data() + i, ct.data() + i, std::min(piece, length - i));
+		}
+		if(ct != expected || stream.final() != 0xfffffffc + (length+31)/32) {
+			std::cout << "\nFAILED: stream with pieces from " << step << " bytes";
+			passed = false;
+		}
+	}
+	return passed;
+}
+
+// check FullTimePadPrefetch against transform for consecutive messages, with a small ring so it wraps and runs empty
+template<FullTimePad::Version version>
+bool test_prefetch()
+{
+	uint8_t key[FullTimePad::keysize];
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) key[i] = i*7+3;
+	FullTimePad fulltimepad = FullTimePad(key);
+
+	bool passed = true;
+	for(size_t capacity : {2, 8, 1024}) {
+		FullTimePadPrefetch<version> prefetch(fulltimepad, 0xfffffff0, capacity, capacity/4);
+		uint64_t encryption_index = 0xfffffff0;
+		for(size_t length=0;length<2000;length+=37) {
+			std::vector<uint8_t> pt(length);
+			std::vector<uint8_t> ct(length);
+			std::vector<uint8_t> expected(length);
+			for(size_t i=0;i<length;i++) pt[i] = i*13;
+
+			// messages get consecutive encryption indexes
+			if(prefetch.transform(pt.data(), ct.data(), length) != encryption_index) {
+				std::cout << "\nFAILED: prefetch encryption index, length " << length;
+				passed = false;
+			}
+			fulltimepad.transform<version>(pt.data(), expected.data(), length, encryption_index);
+			if(ct != expected) {
+				std::cout << "\nFAILED: prefetch capacity " << capacity << ", length " << length;
+				passed = false;
+			}
+			encryption_index += (length+31)/32;
+		}
+	}
+	return passed;
+}
+
+// check transform_range and transform_ranges against slices of a whole-message transform
+template<FullTimePad::Version version>
+bool test_range()
+{
+	uint8_t key[FullTimePad::keysize];
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) key[i] = i*7+3;
+	FullTimePad fulltimepad = FullTimePad(key);
+
+	const size_t length = 4099;
+	std::vector<uint8_t> pt(length);
+	std::vector<uint8_t> ct(length);
+	for(size_t i=0;i<length;i++) pt[i] = i*13;
+	fulltimepad.transform<version>(pt.data(), ct.data(), length, 0xfffffffc);
+
+	bool passed = true;
+	std::vector<uint8_t> out(length);
+	for(size_t offset : {0, 1, 31, 32, 33, 100, 1000, 4000}) {
+		for(size_t range_length : {0, 1, 30, 31, 32, 64, 65, 99}) {
+			range_length = std::min(range_length, length - offset);
+			fulltimepad.transform_range<version>(ct.data() + offset, out.data(), offset, range_length, 0xfffffffc);
+			if(memcmp(out.data(), pt.data() + offset, range_length) != 0) {
+				std::cout << "\nFAILED: range offset " << offset << ", length " << range_length;
+				passed = false;
+			}
+		}
+	}
+
+	// vectored, in-place, disjoint ranges
+	std::vector<uint8_t> data = ct;
+	std::vector<FullTimePad::Range> ranges;
+	for(size_t offset : {1, 60, 200, 1000, 4000}) {
+		ranges.push_back({data.data() + offset, data.data() + offset, offset, std::min<size_t>(50, length - offset)});
+	}
+	fulltimepad.transform_ranges<version>(ranges, 0xfffffffc);
+	for(const FullTimePad::Range &range : ranges) {
+		if(memcmp(data.data() + range.offset, pt.data() + range.offset, range.length) != 0) {
+			std::cout << "\nFAILED: vectored range offset " << range.offset;
+			passed = false;
+		}
+	}
+	return passed;
+}
+
+// FullTimePad is move-only, and a moved object gives the same keystream
+static_assert(!std::is_copy_constructible_v<FullTimePad> && std::is_nothrow_move_constructible_v<FullTimePad>);
+bool test_move()
+{
+	uint8_t key[FullTimePad::keysize];
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) key[i] = i*7+3;
+	FullTimePad fulltimepad = FullTimePad(key);
+	memset(key, 0, FullTimePad::keysize); // the key is copied at construction
+
+	uint8_t expected[FullTimePad::keysize];
+	uint8_t keystream[FullTimePad::keysize];
+	fulltimepad.hash<FullTimePad::Version20>(expected, 5);
+	FullTimePad moved = std::move(fulltimepad);
+	moved.hash<FullTimePad::Version20>(keystream, 5);
+	if(memcmp(expected, keystream, FullTimePad::keysize) != 0) {
+		std::cout << "\nFAILED: moved key";
+		return false;
+	}
+	return true;
+}
+
+// known answers at compile time, key i*7+3 and encryption index 0x123456789abcdef. The keystream is the native
+// representation of the key words, these are the little endian bytes
+constexpr std::array<uint8_t, FullTimePad::keysize> constexpr_key = [] {
+	std::array<uint8_t, FullTimePad::keysize> key{};
+	for(uint8_t i=0;i<FullTimePad::keysize;i++) key[i] = i*7+3;
+	return key;
+}();
+static_assert(std::endian::native == std::endian::big || FullTimePad::hash<FullTimePad::Version10>(constexpr_key, 0x123456789abcdef) == std::array<uint8_t, FullTimePad::keysize>{
+	0xa8, 0x59, 0xbe, 0x30, 0xd6, 0xd2, 0xe3, 0xd3, 0x58, 0xe5, 0x1b, 0x0d, 0x84, 0xf1, 0xd8, 0x43, 0x4c, 0x70, 0xa3, 0x9f, 0xb0, 0xa9, 0xf8, 0x09, 0x74, 0x8c, 0xaf, 0xdb, 0xf5, 0x42, 0x9e, 0xf0});
+static_assert(std::endian::native == std::endian::big || FullTimePad::hash<FullTimePad::Version11>(constexpr_key, 0x123456789abcdef) == std::array<uint8_t, FullTimePad::keysize>{
+	0x3e, 0xd0, 0x32, 0x7f, 0xfa, 0xdd, 0x58, 0x38, 0xf4, 0x5d, 0x04, 0xa6, 0x78, 0x4b, 0x0d, 0x0e, 0x03, 0x9e, 0xdb, 0x09, 0x2e, 0xb1, 0x87, 0x81, 0x6c, 0x97, 0x3d, 0xe0, 0x98, 0x70, 0x6b, 0xc3});
+static_assert(std::endian::native == std::endian::big || FullTimePad::hash<FullTimePad::Version20>(constexpr_key, 0x123456789abcdef) == std::array<uint8_t, FullTimePad::keysize>{
+	0xa6, 0xe7, 0x5b, 0x1a, 0x52, 0x0e, 0x1a, 0xec, 0x1e, 0x35, 0x99, 0x2c, 0xb0, 0xca, 0x0e, 0xb7, 0x18, 0x5a, 0x07, 0x7d, 0xdb, 0xc3, 0x60, 0x49, 0xd0, 0x4c, 0x92, 0xb8, 0x1a, 0x26, 0x0f, 0xa5});
+
+// check the constexpr hash and transform against the object, evaluated at run time, and the hash of a schedule table
+// (how best_permutation runs its candidates) with the shipped table
+template<FullTimePad::Version version>
+bool test_constexpr()
+{
+	std::array<uint8_t, FullTimePad::keysize> key = constexpr_key;
+	FullTimePad fulltimepad = FullTimePad(key.data());
+
+	bool passed = true;
+	uint8_t keystream[FullTimePad::keysize];
+	for(uint64_t encryption_index : encryption_indexes) {
+		for(uint64_t i=0;i<64;i++) {
+			key[i%FullTimePad::keysize] ^= i; // different keys through the same code
+			FullTimePad other = FullTimePad(key.data());
+			other.hash<version>(keystream, encryption_index + i);
+			if(memcmp(keystream, FullTimePad::hash<version>(key, encryption_index + i).data(), FullTimePad::keysize) != 0) {
+				std::cout << "\nFAILED: constexpr hash, encryption index " << encryption_index + i;
+				passed = false;
+			}
+			if(FullTimePad::hash<version>(key, encryption_index + i, FullTimePad::DefaultSchedule::n_V_big_endian) != FullTimePad::hash<version>(key, encryption_index + i)) {
+				std::cout << "\nFAILED: hash with the schedule table, encryption index " << encryption_index + i;
+				passed = false;
+			}
+		}
+	}
+
+	// a fixed message with a partial last block
+	std::array<uint8_t, 100> pt{};
+	for(uint8_t i=0;i<pt.size();i++) pt[i] = i*13;
+	uint8_t ct[pt.size()];
+	fulltimepad.transform<version>(pt.data(), ct, pt.size(), 0xfffffffc);
+	if(memcmp(ct, FullTimePad::transform<version>(constexpr_key, pt, 0xfffffffc).data(), pt.size()) != 0) {
+		std::cout << "\nFAILED: constexpr transform";
+		passed = false;
+	}
+	return passed;
+}
+
+// check hash_many against one object per key, for counts around the 8 and 16 lane boundaries
+template<FullTimePad::Version version>
+bool test_hash_many()
+{
+	static const size_t counts[] = {0, 1, 7, 8, 9, 15, 16, 17, 40};
+
+	bool passed = true;
+	for(size_t n : counts) {
+		std::vector<uint8_t> keys(n*FullTimePad::keysize);
+		std::vector<uint64_t> indexes(n);
+		for(size_t i=0;i<keys.size();i++) keys[i] = i*31+7;
+		for(size_t i=0;i<n;i++) indexes[i] = encryption_indexes[i%3] + i;
+
+		std::vector<uint8_t> out(n*FullTimePad::keysize);
+		FullTimePad::hash_many<version>(keys.data(), indexes.data(), out.data(), n);
+
+		uint8_t transformed_key[FullTimePad::keysize];
+		for(size_t i=0;i<n;i++) {
+			FullTimePad fulltimepad = FullTimePad(keys.data() + i*FullTimePad::keysize);
+			fulltimepad.hash<version>(transformed_key, indexes[i]);
+			if(memcmp(transformed_key, out.data() + i*FullTimePad::keysize, FullTimePad::keysize) != 0) {
+				std::cout << "\nFAILED: " << n << " keys, key " << i;
+				passed = false;
+			}
+		}
+	}
+	return passed;
+}
+
+// check the scalar mod_fp and the lane add/mod_fp of the SIMD kernels against x % fp: around multiples of fp, at the 32 and
+// 64-bit boundaries, and with the most carries the lane add counts in the rounds (a sum of 8 words)
+bool test_mod_fp()
+{
+	const uint64_t fp = FullTimePad::fp;
+	std::vector<uint64_t> values = {0xffffffff, 0x100000000, 0xffffffffffffffff, (uint64_t(1) << 61) - 1};
+	for(uint64_t k : {uint64_t(1), uint64_t(2), uint64_t(5), uint64_t(6), uint64_t(0xffffffff), (uint64_t(1) << 29) - 1, UINT64_MAX/fp}) {
+		for(int d : {-1, 0, 1}) {
+			if(d > 0 && k*fp == UINT64_MAX) continue;
+			values.push_back(k*fp + d);
+		}
+	}
+
+	bool passed = true;
+	for(uint64_t x : values) {
+		if(FullTimePad::mod_fp(x) != x % fp) {
+			std::cout << "\nFAILED: mod_fp(" << x << ")";
+			passed = false;
+		}
+	}
+
+	// the lane mod_fp takes hi < 2^29, 2^64-1 is only for the scalar one. Lane i holds value i, then sums of n words
+	[[maybe_unused]] auto lanes = [&]<typename Kernel, typename Vector>(const char *name) {
+		constexpr size_t n_lanes = sizeof(Vector)/sizeof(uint32_t);
+		auto mod_fp = [](const uint32_t *lo, const uint32_t *hi, uint32_t *out) {
+			Vector lo_v, hi_v;
+			memcpy(&lo_v, lo, sizeof(Vector));
+			memcpy(&hi_v, hi, sizeof(Vector));
+			const Vector x = Kernel::mod_fp(lo_v, hi_v);
+			memcpy(out, &x, sizeof(Vector));
+		};
+
+		for(size_t i=0;i<values.size();i+=n_lanes) {
+			uint32_t lo[n_lanes] = {}, hi[n_lanes] = {}, out[n_lanes];
+			for(size_t j=0;j<n_lanes && i+j<values.size();j++) {
+				if(values[i+j] >> 61) continue; // out of range of the lanes, 0 instead
+				lo[j] = values[i+j];
+				hi[j] = values[i+j] >> 32;
+			}
+			mod_fp(lo, hi, out);
+			for(size_t j=0;j<n_lanes;j++) {
+				const uint64_t x = uint64_t(hi[j]) << 32 | lo[j];
+				if(out[j] != x % fp) {
+					std::cout << "\nFAILED: " << name << " mod_fp(" << x << ")";
+					passed = false;
+				}
+			}
+		}
+
+		// lane 0 adds only 0xffffffff words: 7 carries for 8 words, the most a round counts
+		static const uint32_t words[] = {0xffffffff, 0xfffffffb, 0xfffffffa, 0x80000000, 0x7fffffff, 1, 0};
+		for(uint8_t n=1;n<=8;n++) {
+			uint32_t word[8][n_lanes];
+			uint64_t sum[n_lanes] = {};
+			for(uint8_t w=0;w<n;w++) {
+				for(size_t j=0;j<n_lanes;j++) {
+					word[w][j] = j == 0 ? 0xffffffff : words[(w*3 + j) % std::size(words)];
+					sum[j] += word[w][j];
+				}
+			}
+			Vector lo_v, hi_v = Kernel::zero(), x;
+			memcpy(&lo_v, word[0], sizeof(Vector));
+			for(uint8_t w=1;w<n;w++) {
+				memcpy(&x, word[w], sizeof(Vector));
+				Kernel::add(lo_v, hi_v, x);
+			}
+			uint32_t lo[n_lanes], hi[n_lanes], out[n_lanes];
+			memcpy(lo, &lo_v, sizeof(Vector));
+			memcpy(hi, &hi_v, sizeof(Vector));
+			mod_fp(lo, hi, out);
+			for(size_t j=0;j<n_lanes;j++) {
+				if((uint64_t(hi[j]) << 32 | lo[j]) != sum[j] || out[j] != sum[j] % fp) {
+					std::cout << "\nFAILED: " << name << " add of " << int(n) << " words, lane " << j;
+					passed = false;
+				}
+			}
+		}
+	};
+	#ifdef __AVX2__
+	lanes.template operator()<FullTimePad::avx2_kernel<FullTimePad::DefaultSchedule>, __m256i>("avx2");
+	#endif
+	#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VBMI__)
+	lanes.template operator()<FullTimePad::avx512_kernel<FullTimePad::DefaultSchedule>, __m512i>("avx512");
+	#endif
+	return passed;
+}
+
+// check the counts of a transform, per thread label. Compiled out, nothing is counted
+bool test_instrumentation()
+{
+	if(!Instrumentation::enabled) return Instrumentation::snapshot().empty();
+
+	uint8_t key[FullTimePad::keysize] = {};
+	FullTimePad fulltimepad = FullTimePad(key);
+	const int v = Instrumentation::version_index(FullTimePad::Version20);
+	const Instrumentation::Snapshot before = Instrumentation::total(Instrumentation::snapshot());
+
+	// 31 full blocks and a partial one, through the SIMD kernels when they are built
+	std::vector<uint8_t> data(1000);
+	fulltimepad.transform<FullTimePad::Version20>(std::as_writable_bytes(std::span(data)), 0);
+
+	// 2 blocks on a labelled thread
+	std::thread service([&]() {
+		Instrumentation::set_thread_label("service");
+		fulltimepad.transform<FullTimePad::Version20>(std::as_writable_bytes(std::span(data.data(), 64)), 0);
+	});
+	service.join();
+
+	const std::vector<Instrumentation::Snapshot> snapshots = Instrumentation::snapshot();
+	const Instrumentation::Snapshot after = Instrumentation::total(snapshots);
+	bool passed = true;
+	if(after.phase[v][Instrumentation::Transformation].blocks - before.phase[v][Instrumentation::Transformation].blocks != 34) {
+		std::cout << "\nFAILED: transformation blocks";
+		passed = false;
+	}
+	if(after.phase[v][Instrumentation::Permutation].calls - before.phase[v][Instrumentation::Permutation].calls != 34*2) {
+		std::cout << "\nFAILED: permutations";
+		passed = false;
+	}
+	if(after.phase[v][Instrumentation::Xor].bytes - before.phase[v][Instrumentation::Xor].bytes != 1064) {
+		std::cout << "\nFAILED: XOR bytes";
+		passed = false;
+	}
+	const auto labelled = std::find_if(snapshots.begin(), snapshots.end(), [](const Instrumentation::Snapshot &s) { return s.label == "service"; });
+	if(labelled == snapshots.end() || labelled->phase[v][Instrumentation::Xor].bytes != 64) {
+		std::cout << "\nFAILED: thread label";
+		passed = false;
+	}
+	return passed;
+}
+
+int main()
+{
+	bool passed = true;
+	std::cout << "\nTESTING MOVE: ";
+	passed &= test_move();
+	std::cout << "\nTESTING MOD FP: ";
+	passed &= test_mod_fp();
+	std::cout << "\nTESTING INSTRUMENTATION: ";
+	passed &= test_instrumentation();
+	std::cout << "\nTESTING CONSTEXPR - VERSION 1.0: ";
+	passed &= test_constexpr<FullTimePad::Version10>();
+	std::cout << "\nTESTING CONSTEXPR - VERSION 1.1: ";
+	passed &= test_constexpr<FullTimePad::Version11>();
+	std::cout << "\nTESTING CONSTEXPR - VERSION 2.0: ";
+	passed &= test_constexpr<FullTimePad::Version20>();
+	std::cout << "\nTESTING TRANSFORM - VERSION 1.0: ";
+	passed &= test_transform<FullTimePad::Version10>();
+	std::cout << "\nTESTING TRANSFORM - VERSION 1.1: ";
+	passed &= test_transform<FullTimePad::Version11>();
+	std::cout << "\nTESTING TRANSFORM - VERSION 2.0: ";
+	passed &= test_transform<FullTimePad::Version20>();
+
+	std::cout << "\nTESTING HASH MANY - VERSION 1.0: ";
+	passed &= test_hash_many<FullTimePad::Version10>();
+	std::cout << "\nTESTING HASH MANY - VERSION 1.1: ";
+	passed &= test_hash_many<FullTimePad::Version11>();
+	std::cout << "\nTESTING HASH MANY - VERSION 2.0: ";
+	passed &= test_hash_many<FullTimePad::Version20>();
+
+	std::cout << "\nTESTING PARALLEL TRANSFORM - VERSION 1.0: ";
+	passed &= test_parallel_transform<FullTimePad::Version10>();
+	std::cout << "\nTESTING PARALLEL TRANSFORM - VERSION 1.1: ";
+	passed &= test_parallel_transform<FullTimePad::Version11>();
+	std::cout << "\nTESTING PARALLEL TRANSFORM - VERSION 2.0: ";
+	passed &= test_parallel_transform<FullTimePad::Version20>();
+
+	std::cout << "\nTESTING STREAM - VERSION 1.0: ";
+	passed &= test_stream<FullTimePad::Version10>();
+	std::cout << "\nTESTING STREAM - VERSION 1.1: ";
+	passed &= test_stream<FullTimePad::Version11>();
+	std::cout << "\nTESTING STREAM - VERSION 2.0: ";
+	passed &= test_stream<FullTimePad::Version20>();
+
+	std::cout << "\nTESTING PREFETCH - VERSION 1.0: ";
+	passed &= test_prefetch<FullTimePad::Version10>();
+	std::cout << "\nTESTING PREFETCH - VERSION 1.1: ";
+	passed &= test_prefetch<FullTimePad::Version11>();
+	std::cout << "\nTESTING PREFETCH - VERSION 2.0: ";
+	passed &= test_prefetch<FullTimePad::Version20>();
+
+	std::cout << "\nTESTING RANGE - VERSION 1.0: ";
+	passed &= test_range<FullTimePad::Version10>();
+	std::cout << "\nTESTING RANGE - VERSION 1.1: ";
+	passed &= test_range<FullTimePad::Version11>();
+	std::cout << "\nTESTING RANGE - VERSION 2.0: ";
+	passed &= test_range<FullTimePad::Version20>();
+
+	std::cout << std::endl << (passed ? "PASSED" : "FAILED") << std::endl;
+	return passed ? 0 : 1;
+}
+
+#endif /* KERNELS_CPP */
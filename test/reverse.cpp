@@ -35,10 +35,6 @@
 template<FullTimePad::Version version>
 void inv_transformation(uint8_t *transformed_k)
 {
-	// vector used for dynamic permutation, dynamically permutated key placeholder
-	// use stack memory but for really large nubmer of encryptions performed at once, it might be too much for stack, but that is very unlikely.
-	uint8_t p[FullTimePad::keysize];
-
 	// 32-bit array ints for key for arithmetic ARX manipulations
 	uint32_t *k = FullTimePad::endian_8_to_32_arr(transformed_k); // length of k is 8
 
@@ -66,7 +62,7 @@ void inv_transformation(uint8_t *transformed_k)
 			uint8_t rmod = i % 5; // 5 rotation values
 
 			// permutate the bytearray key
-			FullTimePad::dynamic_permutation(transformed_k, p, i);
+			FullTimePad::dynamic_permutation(transformed_k, i);
 
 			k[i4mod] =( (uint64_t)(A[imod8] ^ k[i4mod]) - (A[imod9] ^ k[i3mod]) ) % FullTimePad::fp;
 
@@ -91,7 +87,7 @@ void inv_transformation(uint8_t *transformed_k)
 			uint8_t rmod = i % 5; // 5 rotation values
 
 			// permutate the bytearray key
-			FullTimePad::dynamic_permutation(transformed_k, p, i);
+			FullTimePad::dynamic_permutation(transformed_k, i);
 
 			k[i4mod] = (A[imod8] ^ k[i4mod]) % FullTimePad::fp;
 			k[i3mod] = (A[imod8] ^ k[i3mod]) % FullTimePad::fp;
@@ -116,7 +112,7 @@ void inv_transformation(uint8_t *transformed_k)
 			uint8_t rmod = i % 5; // 5 rotation values
 
 			// permutate the bytearray key
-			FullTimePad::dynamic_permutation(transformed_k, p, i);
+			FullTimePad::dynamic_permutation(transformed_k, i);
 
 			k[i4mod] = A[imod8] ^ k[i4mod];
 			k[i3mod] = A[imod8] ^ k[i3mod];
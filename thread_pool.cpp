@@ -0,0 +1,118 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef THREAD_POOL_CPP
+#define THREAD_POOL_CPP
+
+#include "thread_pool.h"
+
+// pool whose tasks the calling thread is running, a parallel_for on it from inside a task runs inline
+static thread_local const ThreadPool *running = nullptr;
+
+// threads: total threads working on a parallel_for, including the calling thread
+ThreadPool::ThreadPool(unsigned int threads)
+{
+	// hardware_concurrency() can return 0 if it isn't known
+	for(unsigned int i=1;i<threads;i++) {
+		workers.emplace_back(&ThreadPool::worker, this);
+	}
+}
+
+// take task indexes until there are none left
+void ThreadPool::run_tasks()
+{
+	const ThreadPool *outer = running;
+	running = this;
+	for(size_t i=next.fetch_add(1, std::memory_order_relaxed);i<count;i=next.fetch_add(1, std::memory_order_relaxed)) {
+		(*task)(i);
+	}
+	running = outer;
+}
+
+// worker thread loop
+void ThreadPool::worker()
+{
+	uint64_t seen = 0; // last generation this worker ran
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			start.wait(lock, [&] { return stop || generation != seen; });
+			if(stop) return;
+			seen = generation;
+		}
+
+		run_tasks();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if(--active == 0) done.notify_one();
+	}
+}
+
+// run task(i) for every i in [0, count) on all threads. returns after every task is done
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)> &task)
+{
+	// from inside one of this pool's tasks: the outer job holds submit and the other threads, waiting for them would deadlock
+	if(running == this) {
+		for(size_t i=0;i<count;i++) task(i);
+		return;
+	}
+
+	std::lock_guard<std::mutex> job(submit);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		this->count = count;
+		next.store(0, std::memory_order_relaxed);
+		active = workers.size();
+		generation++;
+	}
+	start.notify_all();
+
+	// the calling thread works too
+	run_tasks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&] { return active == 0; });
+	this->task = nullptr;
+}
+
+// total threads working on a parallel_for
+unsigned int ThreadPool::size() const noexcept
+{
+	return workers.size() + 1;
+}
+
+// shared pool with one thread per core
+ThreadPool &ThreadPool::global()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+// Destructor, joins the workers
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	start.notify_all();
+	for(std::thread &worker : workers) worker.join();
+}
+
+#endif /* THREAD_POOL_CPP */
@@ -0,0 +1,86 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// persistent worker threads for parallel_transform. The threads are created once and wait for work,
+// so a parallel call doesn't pay for thread creation
+class ThreadPool
+{
+	private:
+			std::vector<std::thread> workers;
+
+			// one parallel_for at a time
+			std::mutex submit;
+
+			// protects the current job and generation
+			std::mutex mutex;
+			std::condition_variable start;
+			std::condition_variable done;
+
+			// current job: task(i) for i in [0, count)
+			const std::function<void(size_t)> *task = nullptr;
+			size_t count = 0;
+			std::atomic<size_t> next{0};
+
+			// workers that haven't finished the current job
+			size_t active = 0;
+
+			// incremented for every job, workers wait for it to change
+			uint64_t generation = 0;
+			bool stop = false;
+
+			// worker thread loop
+			void worker();
+
+			// take task indexes until there are none left
+			void run_tasks();
+
+	public:
+			// threads: total threads working on a parallel_for, including the calling thread
+			explicit ThreadPool(unsigned int threads = std::thread::hardware_concurrency());
+
+			ThreadPool(const ThreadPool &) = delete;
+			ThreadPool &operator=(const ThreadPool &) = delete;
+
+			// run task(i) for every i in [0, count) on all threads. returns after every task is done.
+			// Calls from several threads take turns, each one gets all threads when it's its turn. A call from inside a task
+			// of the same pool runs every task on the calling thread instead
+			void parallel_for(size_t count, const std::function<void(size_t)> &task);
+
+			// total threads working on a parallel_for
+			unsigned int size() const noexcept;
+
+			// shared pool with one thread per core
+			static ThreadPool &global();
+
+			// Destructor, joins the workers
+			~ThreadPool();
+};
+
+#endif /* THREAD_POOL_H */
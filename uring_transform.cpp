@@ -0,0 +1,370 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef URING_TRANSFORM_CPP
+#define URING_TRANSFORM_CPP
+
+#include "uring_transform.h"
+
+#ifdef FULLTIMEPAD_URING
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// alignment of O_DIRECT offsets, lengths and buffers
+static const size_t direct_alignment = 4096;
+
+// submission and completion queues of an io_uring instance
+class Uring
+{
+	private:
+			int fd = -1;
+
+			// mapped rings
+			void *sq_ring = MAP_FAILED;
+			void *cq_ring = MAP_FAILED;
+			size_t sq_ring_size = 0;
+			size_t cq_ring_size = 0;
+			io_uring_sqe *sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+			size_t sqes_size = 0;
+
+			// shared with the kernel
+			unsigned *sq_tail, *sq_mask, *sq_array;
+			unsigned *cq_head, *cq_tail, *cq_mask;
+			io_uring_cqe *cqes;
+
+			// sqes added since the last submit
+			unsigned to_submit = 0;
+
+	public:
+			// entries: submission queue size
+			// returns 0, or -errno in error
+			int setup(unsigned int entries)
+			{
+				io_uring_params params = {};
+				fd = syscall(__NR_io_uring_setup, entries, &params);
+				if(fd < 0) return -errno;
+
+				sq_ring_size = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+				cq_ring_size = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+				if(params.features & IORING_FEAT_SINGLE_MMAP) {
+					sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+				}
+				sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+				if(sq_ring == MAP_FAILED) return -errno;
+				if(params.features & IORING_FEAT_SINGLE_MMAP) {
+					cq_ring = sq_ring;
+				}
+				else {
+					cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+					if(cq_ring == MAP_FAILED) return -errno;
+				}
+				sqes_size = params.sq_entries*sizeof(io_uring_sqe);
+				sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+				if(sqes == MAP_FAILED) return -errno;
+
+				uint8_t *sq = static_cast<uint8_t*>(sq_ring);
+				sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+				sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+				sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+				uint8_t *cq = static_cast<uint8_t*>(cq_ring);
+				cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+				cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+				cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+				cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+				return 0;
+			}
+
+			// register buffers for READ_FIXED/WRITE_FIXED, returns 0 or -errno
+			int register_buffers(const std::vector<iovec> &iovecs)
+			{
+				if(syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iovecs.data(), iovecs.size()) < 0) return -errno;
+				return 0;
+			}
+
+			// queue a read or write, there's always room as there are no more operations in flight than entries
+			void queue(uint8_t opcode, int file, uint8_t *data, unsigned int length, uint64_t offset, uint16_t buffer, uint64_t user_data)
+			{
+				const unsigned tail = *sq_tail;
+				const unsigned index = tail & *sq_mask;
+				io_uring_sqe &sqe = sqes[index];
+				sqe = {};
+				sqe.opcode = opcode;
+				sqe.fd = file;
+				sqe.addr = reinterpret_cast<uint64_t>(data);
+				sqe.len = length;
+				sqe.off = offset;
+				sqe.buf_index = buffer;
+				sqe.user_data = user_data;
+				sq_array[index] = index;
+				__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+				to_submit++;
+			}
+
+			// submit the queued operations, and wait for at least wait completions
+			// returns 0, or -errno
+			int submit(unsigned int wait)
+			{
+				while(true) {
+					const int submitted = syscall(__NR_io_uring_enter, fd, to_submit, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+					if(submitted >= 0) {
+						to_submit -= submitted;
+						return 0;
+					}
+					if(errno != EINTR) return -errno;
+				}
+			}
+
+			// call f(user_data, res) for every completion
+			template<typename F>
+			void complete(F f)
+			{
+				unsigned head = *cq_head;
+				const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+				for(;head!=tail;head++) {
+					const io_uring_cqe &cqe = cqes[head & *cq_mask];
+					f(cqe.user_data, cqe.res);
+				}
+				__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+			}
+
+			~Uring()
+			{
+				if(sqes != MAP_FAILED) munmap(sqes, sqes_size);
+				if(cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+				if(sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+				if(fd >= 0) close(fd);
+			}
+};
+
+// encrypt/decrypt length bytes of in_fd into out_fd at the same offsets on io_uring
+// returns 0, or -errno
+template<FullTimePad::Version version>
+int uring_transform(FullTimePad &fulltimepad, int in_fd, int out_fd, uint64_t length, uint64_t encryption_index, ThreadPool &pool,
+                    bool direct, unsigned int buffers, size_t buffer_size)
+{
+	buffer_size = (buffer_size + direct_alignment - 1) & ~(direct_alignment - 1);
+	buffers = std::max(buffers, 1u);
+
+	// one more entry for the read of the eventfd
+	Uring uring;
+	int err = uring.setup(buffers + 1);
+	if(err != 0) return err;
+
+	const int notify_fd = eventfd(0, EFD_CLOEXEC);
+	if(notify_fd < 0) return -errno;
+
+	// the eventfd counter is read into the allocation too, so it outlives the read when the memory is left to the kernel
+	uint8_t *memory = static_cast<uint8_t*>(aligned_alloc(direct_alignment, buffers*buffer_size + direct_alignment));
+	if(memory == nullptr) {
+		close(notify_fd);
+		return -ENOMEM;
+	}
+	uint8_t *notify_value = memory + buffers*buffer_size;
+
+	// registered buffers skip the page pinning of every operation, plain reads/writes if the memlock limit is too low
+	std::vector<iovec> iovecs(buffers);
+	for(unsigned int i=0;i<buffers;i++) iovecs[i] = {memory + i*buffer_size, buffer_size};
+	const bool fixed = uring.register_buffers(iovecs) == 0;
+	const uint8_t read_op = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	const uint8_t write_op = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+
+	// every buffer holds [offset, offset+length) of the file, and is read, transformed then written
+	struct Slot {
+		uint64_t offset;
+		size_t length; // data bytes
+		size_t io_length; // length padded for O_DIRECT
+		size_t done; // bytes read/written so far
+		bool writing;
+	};
+	std::vector<Slot> slots(buffers);
+	std::vector<unsigned int> free_slots;
+	for(unsigned int i=buffers;i>0;i--) free_slots.push_back(i-1);
+
+	auto queue = [&](unsigned int i) {
+		Slot &slot = slots[i];
+		uring.queue(slot.writing ? write_op : read_op, slot.writing ? out_fd : in_fd, memory + i*buffer_size + slot.done,
+		            slot.io_length - slot.done, slot.offset + slot.done, fixed ? i : 0, i);
+	};
+
+	// the read buffers are transformed on the pool by the transformer thread, so the ring loop keeps reaping and queueing
+	// meanwhile. A transformed buffer is put on the transformed list and the eventfd is signalled, which completes the read
+	// the ring keeps queued on it, and the ring loop queues its write
+	const uint64_t notify_data = buffers;
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<unsigned int> to_transform;
+	std::vector<unsigned int> transformed;
+	bool stop = false;
+	std::thread transformer([&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while(true) {
+			cv.wait(lock, [&]() { return stop || !to_transform.empty(); });
+			if(to_transform.empty()) return;
+			const unsigned int i = to_transform.front();
+			to_transform.pop_front();
+			lock.unlock();
+
+			uint8_t *data = memory + i*buffer_size;
+			fulltimepad.parallel_transform<version>(data, data, slots[i].length, encryption_index + slots[i].offset/FullTimePad::keysize, pool);
+			// the O_DIRECT pad is written too, zeroed so it doesn't carry what a previous use of the buffer left in it
+			memset(data + slots[i].length, 0, slots[i].io_length - slots[i].length);
+
+			lock.lock();
+			transformed.push_back(i);
+			eventfd_write(notify_fd, 1);
+		}
+	});
+	uring.queue(IORING_OP_READ, notify_fd, notify_value, sizeof(eventfd_t), 0, 0, notify_data);
+	bool notify_queued = true;
+	bool notify_stopping = false;
+
+	uint64_t next_offset = 0;
+	unsigned int in_flight = 0; // buffers being read, transformed or written
+	while(in_flight != 0 || notify_queued) {
+		// start a read in every free buffer
+		while(!free_slots.empty() && next_offset < length && err == 0) {
+			const unsigned int i = free_slots.back();
+			free_slots.pop_back();
+			Slot &slot = slots[i];
+			slot.offset = next_offset;
+			slot.length = std::min<uint64_t>(buffer_size, length - next_offset);
+			slot.io_length = direct ? (slot.length + direct_alignment - 1) & ~(direct_alignment - 1) : slot.length;
+			slot.done = 0;
+			slot.writing = false;
+			queue(i);
+			next_offset += slot.length;
+			in_flight++;
+		}
+
+		// all done, complete the read of the eventfd so it isn't left to the kernel
+		if(in_flight == 0 && (next_offset >= length || err != 0) && !notify_stopping) {
+			notify_stopping = true;
+			eventfd_write(notify_fd, 1);
+		}
+
+		const int submit_err = uring.submit(1);
+		if(submit_err != 0) {
+			// nothing in flight can be waited for anymore
+			err = submit_err;
+			break;
+		}
+
+		uring.complete([&](uint64_t i, int res) {
+			if(i == notify_data) {
+				if(res < 0 && res != -EINTR && res != -EAGAIN && err == 0) err = res;
+				std::vector<unsigned int> ready;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					ready.swap(transformed);
+				}
+				for(unsigned int j : ready) {
+					if(err != 0) {
+						free_slots.push_back(j);
+						in_flight--;
+						continue;
+					}
+					slots[j].writing = true;
+					slots[j].done = 0;
+					queue(j);
+				}
+				notify_queued = !notify_stopping;
+				if(notify_queued) uring.queue(IORING_OP_READ, notify_fd, notify_value, sizeof(eventfd_t), 0, 0, notify_data);
+				return;
+			}
+
+			Slot &slot = slots[i];
+			if(res == -EINTR || res == -EAGAIN) {
+				queue(i);
+				return;
+			}
+			if(res < 0 || res == 0 || err != 0) {
+				// error, or the file ended early
+				if(err == 0) err = res < 0 ? res : -EIO;
+				free_slots.push_back(i);
+				in_flight--;
+				return;
+			}
+			const size_t before = slot.done;
+			slot.done += res;
+
+			// an O_DIRECT read ends at the end of the file, which can be before io_length
+			const size_t end = slot.writing ? slot.io_length : slot.length;
+			if(slot.done < end) {
+				// O_DIRECT offsets have to stay aligned, so a short transfer is retried from its last aligned offset.
+				// One that doesn't get past it is a read past the end of the file
+				if(direct) {
+					slot.done &= ~(direct_alignment - 1);
+					if(slot.done == before) {
+						if(err == 0) err = -EIO;
+						free_slots.push_back(i);
+						in_flight--;
+						return;
+					}
+				}
+				queue(i);
+			}
+			else if(!slot.writing) {
+				std::lock_guard<std::mutex> lock(mutex);
+				to_transform.push_back(i);
+				cv.notify_one();
+			}
+			else {
+				free_slots.push_back(i);
+				in_flight--;
+			}
+		});
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+		cv.notify_one();
+	}
+	transformer.join();
+	close(notify_fd);
+
+	// the buffers held plaintext, the kernel is done with them once nothing is in flight
+	if(in_flight == 0 && !notify_queued) {
+		explicit_bzero(memory, buffers*buffer_size);
+		free(memory);
+	}
+	return err;
+}
+
+// Explicit instantiation
+template int uring_transform<FullTimePad::Version10>(FullTimePad &, int, int, uint64_t, uint64_t, ThreadPool &, bool, unsigned int, size_t);
+template int uring_transform<FullTimePad::Version11>(FullTimePad &, int, int, uint64_t, uint64_t, ThreadPool &, bool, unsigned int, size_t);
+template int uring_transform<FullTimePad::Version20>(FullTimePad &, int, int, uint64_t, uint64_t, ThreadPool &, bool, unsigned int, size_t);
+
+#endif
+
+#endif /* URING_TRANSFORM_CPP */
@@ -0,0 +1,48 @@
+/*
+ * Author: Taha
+ * Date: Oct 17, 2026
+ *
+ * Full-Time-Pad Symmetric Stream Cipher
+ *  Copyright (C) 2025  Taha
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ */
+
+#ifndef URING_TRANSFORM_H
+#define URING_TRANSFORM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "fulltimepad.h"
+
+// io_uring is used through its system calls, so there's no liburing dependency
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FULLTIMEPAD_URING 1
+
+// asynchronous file encrypt/decrypt on io_uring. buffers aligned, registered buffers are kept in flight:
+// a read completion is handed to a transformer thread that runs it on the threads of pool, while the ring keeps reaping
+// and queueing the other reads and writes, and the ring writes it back once it's transformed.
+// Byte offset o of the file uses encryption index encryption_index + o/32
+// in_fd: file to read, from offset 0
+// out_fd: file to write at the same offsets, in_fd itself for in-place
+// length: bytes to transform
+// direct: the files are opened with O_DIRECT, the last write is padded to 4096 bytes so out_fd has to be truncated afterwards
+// buffers: buffers in flight
+// buffer_size: bytes per buffer, a multiple of 4096
+// returns 0, or -errno
+template<FullTimePad::Version version>
+int uring_transform(FullTimePad &fulltimepad, int in_fd, int out_fd, uint64_t length, uint64_t encryption_index, ThreadPool &pool,
+                    bool direct = false, unsigned int buffers = 16, size_t buffer_size = 1 << 20);
+
+#endif
+
+#endif /* URING_TRANSFORM_H */